@@ -0,0 +1,552 @@
+#include "BenchmarkService.hpp"
+#include "App/Environment.hpp"
+#include "App/Tweaks/Declarative/TweakImporter.hpp"
+#include "App/Tweaks/TweakService.hpp"
+#include "Bench/Database/MemoryTweakDB.hpp"
+#include "Red/TweakDB/Raws.hpp"
+
+#include <psapi.h>
+
+namespace
+{
+constexpr auto RecordTypeName = "gamedataConstantStatModifier_Record";
+constexpr auto RecordPrefix = "TweakXLBench.";
+constexpr auto ArrayFlatName = "TweakXLBench.Array";
+constexpr auto TemplateDirName = L"TweakXLBench";
+constexpr auto LegacyFlatChunkSize = 16000;
+constexpr auto MaxReadSamples = 1000000;
+constexpr auto MemorySampleInterval = std::chrono::milliseconds(1);
+}
+
+Bench::BenchmarkService::BenchmarkService(std::filesystem::path aReportPath, Options aOptions)
+    : m_reportPath(std::move(aReportPath))
+    , m_options(aOptions)
+    , m_recordType(nullptr)
+{
+}
+
+void Bench::BenchmarkService::OnBootstrap()
+{
+    // The workloads run on their own database, but the record types are taken from the game,
+    // so they can only run once the game database is initialized.
+    HookAfter<Raw::InitTweakDB>([&]() {
+        RunAll();
+    });
+}
+
+void Bench::BenchmarkService::RunAll()
+{
+    m_recordType = Red::CRTTISystem::Get()->GetClass(RecordTypeName);
+
+    // The stand-in has no sample records to discover the record types from,
+    // so the schema is copied from the reflection of the game database, which is only read.
+    auto& gameReflection = Core::Resolve<App::TweakService>()->GetReflection();
+
+    if (!m_recordType || !gameReflection.GetRecordInfo(m_recordType))
+    {
+        LogError("[Bench] Record type {} is not available.", RecordTypeName);
+        return;
+    }
+
+    Bench::MemoryTweakDB::Options databaseOptions;
+    databaseOptions.flats = m_options.baseFlats;
+
+    m_database = Core::MakeUnique<Bench::MemoryTweakDB>(databaseOptions);
+    m_reflection = Core::MakeShared<Red::TweakDBReflection>(m_database->GetTweakDB());
+
+    if (!m_reflection->ImportSchema(gameReflection.ExportSchema()))
+    {
+        LogError("[Bench] Record types can't be imported into the stand-in.");
+        return;
+    }
+
+    m_manager = Core::MakeShared<Red::TweakDBManager>(m_reflection);
+    m_context = Core::MakeShared<App::TweakContext>(App::Env::GameVer());
+
+    LogInfo("[Bench] Stand-in database with {} flats in {} KiB.", m_database->GetFlatCount(),
+            m_database->GetBufferSize() / 1024);
+
+    LogInfo("[Bench] Running benchmarks...");
+
+    RunHashing();
+    RunBuffer();
+    RunFlatMerge();
+    RunRecords();
+    RunFlatReads();
+    RunNames();
+    RunCloneChain();
+    RunArrayMutations();
+    RunTemplates();
+
+    for (const auto& result : m_results)
+    {
+        LogInfo("[Bench] {} | {} ops | {:.3f}s | {:.0f} ops/s | peak +{} KiB | retained +{} KiB | buffer +{} KiB",
+                result.name, result.operations, result.seconds,
+                result.seconds > 0 ? result.operations / result.seconds : 0.0, result.peakMemory / 1024,
+                result.retainedMemory / 1024, result.bufferGrowth / 1024);
+    }
+
+    LogInfo("[Bench] Stand-in buffer uses {} of {} KiB.", m_database->GetBufferSize() / 1024,
+            m_database->GetBufferCapacity() / 1024);
+
+    if (!WriteReport())
+    {
+        LogWarning("[Bench] Can't write report \"{}\".", m_reportPath.string());
+    }
+}
+
+void Bench::BenchmarkService::RunRecords()
+{
+    const auto recordInfo = m_reflection->GetRecordInfo(m_recordType);
+    const auto changeset = Core::MakeShared<App::TweakChangeset>();
+
+    Core::Vector<const Red::TweakDBPropertyInfo*> props;
+    for (const auto& [_, propInfo] : recordInfo->props)
+    {
+        if (props.size() == m_options.props)
+            break;
+
+        props.push_back(propInfo.get());
+    }
+
+    for (uint32_t i = 0; i < m_options.records; ++i)
+    {
+        const auto recordName = std::format("{}Record{}", RecordPrefix, i);
+        const auto recordId = Red::TweakDBID(recordName);
+
+        changeset->MakeRecord(recordId, m_recordType);
+        changeset->RegisterName(recordId, recordName);
+
+        for (const auto* propInfo : props)
+        {
+            auto value = m_reflection->Construct(propInfo->type);
+
+            // Unique values to avoid measuring only the deduplication
+            if (propInfo->type->GetName() == Red::ERTDBFlatType::Float)
+                *reinterpret_cast<float*>(value.get()) = static_cast<float>(i);
+
+            changeset->SetFlat(recordId + propInfo->appendix, propInfo->type, value);
+        }
+    }
+
+    Measure(std::format("Commit {} records x {} props", m_options.records, props.size()),
+            static_cast<uint64_t>(m_options.records) * props.size(), [&]() { Commit(changeset); });
+}
+
+void Bench::BenchmarkService::RunNames()
+{
+    const auto recordInfo = m_reflection->GetRecordInfo(m_recordType);
+
+    // The records are registered with their names by the record workload
+    Core::Vector<Red::TweakDBID> ids;
+    ids.reserve(static_cast<size_t>(m_options.records) * (recordInfo->props.size() + 1));
+
+    for (uint32_t i = 0; i < m_options.records; ++i)
+    {
+        const auto recordId = Red::TweakDBID(std::format("{}Record{}", RecordPrefix, i));
+
+        ids.push_back(recordId);
+
+        for (const auto& [_, propInfo] : recordInfo->props)
+        {
+            ids.push_back(recordId + propInfo->appendix);
+        }
+    }
+
+    size_t nameLength = 0;
+
+    Measure(std::format("Get {} names (first lookup)", ids.size()), ids.size(), [&]() {
+        for (const auto& id : ids)
+        {
+            nameLength += m_manager->GetName(id).size();
+        }
+    });
+
+    Measure(std::format("Get {} names (repeated lookup)", ids.size()), ids.size(), [&]() {
+        for (const auto& id : ids)
+        {
+            nameLength += m_manager->GetName(id).size();
+        }
+    });
+
+    const auto threadCount = std::max(2u, std::thread::hardware_concurrency());
+
+    Measure(std::format("Get {} names from {} threads", ids.size(), threadCount), ids.size() * threadCount, [&]() {
+        Core::Vector<std::thread> threads;
+        std::atomic<size_t> threadNameLength = 0;
+
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&]() {
+                size_t length = 0;
+                for (const auto& id : ids)
+                {
+                    length += m_manager->GetName(id).size();
+                }
+                threadNameLength += length;
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        nameLength += threadNameLength;
+    });
+
+    const auto stats = m_manager->GetNameStats();
+
+    LogInfo("[Bench] Name table: {} names, {} shared, {} appendices, arena {} of {} KiB, index {} KiB.",
+            stats.names, stats.sharedNames, stats.appendices, stats.arenaUsed / 1024, stats.arenaSize / 1024,
+            stats.indexSize / 1024);
+    LogDebug("[Bench] Total name length {}.", nameLength);
+}
+
+void Bench::BenchmarkService::RunCloneChain()
+{
+    const auto changeset = Core::MakeShared<App::TweakChangeset>();
+
+    Red::TweakDBID sourceId = Red::TweakDBID(std::format("{}Record0", RecordPrefix));
+
+    for (uint32_t i = 0; i < m_options.cloneDepth; ++i)
+    {
+        const auto recordName = std::format("{}Clone{}", RecordPrefix, i);
+        const auto recordId = Red::TweakDBID(recordName);
+
+        changeset->MakeRecord(recordId, m_recordType, sourceId);
+        changeset->RegisterName(recordId, recordName);
+
+        sourceId = recordId;
+    }
+
+    Measure(std::format("Commit clone chain of {}", m_options.cloneDepth), m_options.cloneDepth,
+            [&]() { Commit(changeset); });
+}
+
+void Bench::BenchmarkService::RunArrayMutations()
+{
+    const auto flatId = Red::TweakDBID(ArrayFlatName);
+    const auto elementType = m_reflection->GetFlatType(Red::ERTDBFlatType::TweakDBID);
+    const auto arrayType = m_reflection->GetArrayType(elementType);
+
+    {
+        const auto changeset = Core::MakeShared<App::TweakChangeset>();
+        auto value = m_reflection->Construct(arrayType);
+        auto* array = reinterpret_cast<Red::DynArray<Red::TweakDBID>*>(value.get());
+
+        for (uint32_t i = 0; i < m_options.arrayLength; ++i)
+        {
+            array->PushBack(Red::TweakDBID(std::format("{}Record{}", RecordPrefix, i)));
+        }
+
+        changeset->SetFlat(flatId, arrayType, value);
+        Commit(changeset);
+    }
+
+    const auto changeset = Core::MakeShared<App::TweakChangeset>();
+
+    for (uint32_t i = 0; i < m_options.arrayLength; ++i)
+    {
+        auto element = m_reflection->Construct(elementType);
+        *reinterpret_cast<Red::TweakDBID*>(element.get()) = Red::TweakDBID(std::format("{}Clone{}", RecordPrefix, i));
+
+        changeset->AppendElement(flatId, elementType, element);
+
+        if (i % 2 == 0)
+        {
+            auto removal = m_reflection->Construct(elementType);
+            *reinterpret_cast<Red::TweakDBID*>(removal.get()) =
+                Red::TweakDBID(std::format("{}Record{}", RecordPrefix, i));
+
+            changeset->RemoveElement(flatId, elementType, removal);
+        }
+    }
+
+    Measure(std::format("Commit {} array mutations", m_options.arrayLength + m_options.arrayLength / 2),
+            m_options.arrayLength + m_options.arrayLength / 2, [&]() { Commit(changeset); });
+}
+
+void Bench::BenchmarkService::RunTemplates()
+{
+    std::error_code error;
+    const auto templateDir = std::filesystem::temp_directory_path(error) / TemplateDirName;
+
+    std::filesystem::create_directories(templateDir, error);
+
+    {
+        std::ofstream out(templateDir / L"templates.yaml", std::ios::out | std::ios::trunc);
+
+        out << RecordPrefix << "Template_$(name)_$(tier):\n";
+        out << "  $type: ConstantStatModifier\n";
+        out << "  $instances:\n";
+
+        for (uint32_t i = 0; i < m_options.templateInstances; ++i)
+        {
+            out << "    - { name: Instance" << i << ", tier: " << (i % 5) << " }\n";
+        }
+
+        out << "  value: $(tier)\n";
+        out << "  modifierType: Additive\n";
+        out << "  statType: BaseStats.Health\n";
+    }
+
+    App::TweakImporter importer(m_manager, m_context);
+    importer.SetWorkerCount(1);
+
+    Measure(std::format("Import {} template instances", m_options.templateInstances), m_options.templateInstances,
+            [&]() { importer.ImportTweaks({templateDir}); });
+
+    std::filesystem::remove_all(templateDir, error);
+}
+
+void Bench::BenchmarkService::RunBuffer()
+{
+    Red::TweakDBBuffer buffer(m_database->GetTweakDB());
+
+    const auto intType = m_reflection->GetFlatType(Red::ERTDBFlatType::Int);
+    const auto floatType = m_reflection->GetFlatType(Red::ERTDBFlatType::Float);
+
+    // The first access scans the whole flat buffer to build the value pools
+    Measure("Buffer initialization", m_database->GetFlatCount(),
+            [&]() { buffer.AllocateDefault(intType); });
+
+    Measure(std::format("Buffer allocation of {} values", m_options.bufferValues), m_options.bufferValues, [&]() {
+        for (uint32_t i = 0; i < m_options.bufferValues; ++i)
+        {
+            // Every second value is a duplicate of the previous one
+            auto value = static_cast<float>(i / 2) + 0.5f;
+            buffer.AllocateValue(floatType, &value);
+        }
+    });
+
+    const auto stats = buffer.GetStats();
+    LogInfo("[Bench] Buffer pools: {} values | {} read / {} write contentions", stats.poolValues,
+            stats.readContentions, stats.writeContentions);
+}
+
+void Bench::BenchmarkService::RunHashing()
+{
+    using Implementation = Red::TweakDBHasher::Implementation;
+
+    const auto intType = m_reflection->GetFlatType(Red::ERTDBFlatType::Int);
+    const auto blobSize = m_database->GetBufferSize();
+
+    // Every buffer scans the whole stand-in blob with its own hash function
+    for (const auto implementation : {Implementation::FNV1a, Implementation::Scalar, Implementation::SSE2,
+                                      Implementation::AVX2})
+    {
+        if (!Red::TweakDBHasher::IsSupported(implementation))
+            continue;
+
+        Red::TweakDBBuffer buffer(m_database->GetTweakDB(), Red::TweakDBHasher::Get(implementation));
+
+        Measure(std::format("Buffer scan of {} KiB with {}", blobSize / 1024,
+                            Red::TweakDBHasher::GetName(implementation)),
+                m_database->GetFlatCount(), [&]() { buffer.AllocateDefault(intType); });
+    }
+}
+
+void Bench::BenchmarkService::RunFlatMerge()
+{
+    // Half of the changes replace existing flats, the other half are new
+    auto changes = m_database->SampleFlats(m_options.mergeFlats / 2);
+    changes.reserve(m_options.mergeFlats);
+
+    for (auto i = static_cast<uint32_t>(changes.size()); i < m_options.mergeFlats; ++i)
+    {
+        changes.push_back(Red::TweakDBID(std::format("{}Merge{}", RecordPrefix, i)));
+    }
+
+    std::sort(changes.begin(), changes.end());
+
+    // Both strategies work on copies, so the database is not modified
+    Red::SortedUniqueArray<Red::TweakDBID> chunkedFlats;
+    Red::SortedUniqueArray<Red::TweakDBID> sourceFlats;
+
+    m_database->CopyFlats(chunkedFlats);
+    m_database->CopyFlats(sourceFlats);
+
+    Measure(std::format("Merge {} flats in chunks of {}", changes.size(), LegacyFlatChunkSize), changes.size(), [&]() {
+        Red::SortedUniqueArray<Red::TweakDBID> flatsChunk;
+
+        for (const auto& flatId : changes)
+        {
+            flatsChunk.InsertOrAssign(flatId);
+
+            if (flatsChunk.size >= LegacyFlatChunkSize)
+            {
+                chunkedFlats.InsertOrAssign(flatsChunk);
+                flatsChunk.Clear();
+            }
+        }
+
+        if (flatsChunk.size > 0)
+        {
+            chunkedFlats.InsertOrAssign(flatsChunk);
+        }
+    });
+
+    Red::SortedUniqueArray<Red::TweakDBID> mergedFlats;
+
+    Measure(std::format("Merge {} flats linearly", changes.size()), changes.size(),
+            [&]() { Red::TweakDBManager::MergeFlats(sourceFlats, changes, mergedFlats); });
+
+    if (mergedFlats.size != chunkedFlats.size)
+    {
+        LogWarning("[Bench] Merge strategies produced {} and {} flats.", chunkedFlats.size, mergedFlats.size);
+    }
+}
+
+void Bench::BenchmarkService::RunFlatReads()
+{
+    const auto flatIds = m_database->SampleFlats(m_options.readFlats);
+
+    if (flatIds.empty())
+        return;
+
+    const auto recordInfo = m_reflection->GetRecordInfo(m_recordType);
+    const auto readerCount = std::max(1u, std::thread::hardware_concurrency() / 2);
+
+    // The readers measure every lookup while a writer commits new records next to them,
+    // so the tail latency shows how long the readers wait for the writer
+    const auto changeset = Core::MakeShared<App::TweakChangeset>();
+
+    for (uint32_t i = 0; i < m_options.readRecords; ++i)
+    {
+        const auto recordName = std::format("{}Reads{}", RecordPrefix, i);
+        const auto recordId = Red::TweakDBID(recordName);
+
+        changeset->MakeRecord(recordId, m_recordType);
+        changeset->RegisterName(recordId, recordName);
+    }
+
+    std::atomic<bool> stop = false;
+    Core::Vector<Core::Vector<uint32_t>> latencies(readerCount);
+    Core::Vector<std::thread> readers;
+
+    for (uint32_t i = 0; i < readerCount; ++i)
+    {
+        readers.emplace_back([&, i]() {
+            auto& samples = latencies[i];
+            samples.reserve(MaxReadSamples);
+
+            for (size_t j = i; !stop.load(std::memory_order_relaxed) && samples.size() < MaxReadSamples; ++j)
+            {
+                const auto startTime = std::chrono::steady_clock::now();
+                const auto value = m_manager->GetFlat(flatIds[j % flatIds.size()]);
+                const auto endTime = std::chrono::steady_clock::now();
+
+                if (!value.instance)
+                    continue;
+
+                samples.push_back(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count()));
+            }
+        });
+    }
+
+    Measure(std::format("Commit {} records with {} readers", m_options.readRecords, readerCount),
+            static_cast<uint64_t>(m_options.readRecords) * recordInfo->props.size(), [&]() { Commit(changeset); });
+
+    stop = true;
+
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    Core::Vector<uint32_t> samples;
+    for (const auto& readerSamples : latencies)
+    {
+        samples.insert(samples.end(), readerSamples.begin(), readerSamples.end());
+    }
+
+    if (samples.empty())
+        return;
+
+    std::sort(samples.begin(), samples.end());
+
+    const auto percentile = [&](double aRank) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(aRank * samples.size()))];
+    };
+
+    LogInfo("[Bench] Flat reads: {} reads | p50 {} ns | p99 {} ns | p99.9 {} ns | max {} ns", samples.size(),
+            percentile(0.5), percentile(0.99), percentile(0.999), samples.back());
+}
+
+template<typename F>
+void Bench::BenchmarkService::Measure(const std::string& aName, uint64_t aOperations, F&& aWorkload)
+{
+    // The process peak only grows, so the peak of the workload is sampled next to it.
+    // The private memory is shared with the game, the numbers are only comparable between runs of the same setup.
+    const auto memoryBefore = GetPrivateMemory();
+    const auto bufferBefore = m_database->GetBufferSize();
+
+    std::atomic<bool> finished = false;
+    uint64_t memoryPeak = memoryBefore;
+
+    std::thread sampler([&]() {
+        while (!finished.load(std::memory_order_relaxed))
+        {
+            memoryPeak = std::max(memoryPeak, GetPrivateMemory());
+            std::this_thread::sleep_for(MemorySampleInterval);
+        }
+    });
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    aWorkload();
+
+    const auto endTime = std::chrono::steady_clock::now();
+
+    finished = true;
+    sampler.join();
+
+    const auto memoryAfter = GetPrivateMemory();
+    memoryPeak = std::max(memoryPeak, memoryAfter);
+
+    m_results.push_back({aName, aOperations, std::chrono::duration<double>(endTime - startTime).count(),
+                         memoryPeak - memoryBefore, memoryAfter > memoryBefore ? memoryAfter - memoryBefore : 0,
+                         m_database->GetBufferSize() - bufferBefore});
+}
+
+void Bench::BenchmarkService::Commit(const Core::SharedPtr<App::TweakChangeset>& aChangeset)
+{
+    aChangeset->Commit(m_manager, nullptr);
+}
+
+bool Bench::BenchmarkService::WriteReport()
+{
+    std::ofstream out(m_reportPath, std::ios::out | std::ios::trunc);
+
+    if (!out.is_open())
+        return false;
+
+    out << "[\n";
+
+    for (size_t i = 0; i < m_results.size(); ++i)
+    {
+        const auto& result = m_results[i];
+
+        out << std::format(R"(  {{"name": "{}", "operations": {}, "seconds": {:.6f}, "peakMemory": {}, )"
+                           R"("retainedMemory": {}, "bufferGrowth": {}}}{})",
+                           result.name, result.operations, result.seconds, result.peakMemory,
+                           result.retainedMemory, result.bufferGrowth, i + 1 < m_results.size() ? ",\n" : "\n");
+    }
+
+    out << "]\n";
+
+    return out.good();
+}
+
+uint64_t Bench::BenchmarkService::GetPrivateMemory()
+{
+    PROCESS_MEMORY_COUNTERS_EX counters{};
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                              sizeof(counters)))
+        return 0;
+
+    return counters.PrivateUsage;
+}
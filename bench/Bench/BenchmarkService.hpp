@@ -0,0 +1,76 @@
+#pragma once
+
+#include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "App/Tweaks/TweakContext.hpp"
+#include "Bench/Database/TweakDBStandIn.hpp"
+#include "Core/Foundation/Feature.hpp"
+#include "Core/Hooking/HookingAgent.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
+#include "Red/TweakDB/Manager.hpp"
+
+namespace Bench
+{
+class BenchmarkService
+    : public Core::Feature
+    , public Core::HookingAgent
+    , public Core::LoggingAgent
+{
+public:
+    struct Options
+    {
+        uint32_t records = 20000;
+        uint32_t props = 3;
+        uint32_t cloneDepth = 2000;
+        uint32_t arrayLength = 20000;
+        uint32_t templateInstances = 5000;
+        uint32_t bufferValues = 200000;
+        uint32_t mergeFlats = 200000;
+        uint32_t readFlats = 100000;
+        uint32_t readRecords = 5000;
+        uint32_t baseFlats = 500000;
+    };
+
+    BenchmarkService(std::filesystem::path aReportPath, Options aOptions = {});
+
+protected:
+    struct Result
+    {
+        std::string name;
+        uint64_t operations;
+        double seconds;
+        uint64_t peakMemory; // bytes allocated at the peak of the workload
+        uint64_t retainedMemory; // bytes still allocated after the workload
+        uint64_t bufferGrowth; // bytes appended to the flat buffer
+    };
+
+    void OnBootstrap() override;
+
+    void RunAll();
+    void RunRecords();
+    void RunNames();
+    void RunCloneChain();
+    void RunArrayMutations();
+    void RunTemplates();
+    void RunBuffer();
+    void RunHashing();
+    void RunFlatMerge();
+    void RunFlatReads();
+
+    template<typename F>
+    void Measure(const std::string& aName, uint64_t aOperations, F&& aWorkload);
+
+    void Commit(const Core::SharedPtr<App::TweakChangeset>& aChangeset);
+    bool WriteReport();
+
+    static uint64_t GetPrivateMemory();
+
+    std::filesystem::path m_reportPath;
+    Options m_options;
+    Core::UniquePtr<Bench::TweakDBStandIn> m_database;
+    Core::SharedPtr<Red::TweakDBReflection> m_reflection;
+    Core::SharedPtr<Red::TweakDBManager> m_manager;
+    Core::SharedPtr<App::TweakContext> m_context;
+    const Red::CClass* m_recordType;
+    Core::Vector<Result> m_results;
+};
+}
@@ -0,0 +1,179 @@
+#include "MemoryTweakDB.hpp"
+#include "Red/TweakDB/Reflection.hpp"
+
+namespace
+{
+constexpr auto FlatNamePrefix = "TweakXLBench.Base";
+constexpr auto FlatsPerRecord = 8u;
+constexpr auto BufferAlignment = std::align_val_t{16};
+
+// Most common flat types of the game blob
+constexpr uint64_t FlatTypes[] = {
+    Red::ERTDBFlatType::Int,
+    Red::ERTDBFlatType::Float,
+    Red::ERTDBFlatType::Bool,
+    Red::ERTDBFlatType::TweakDBID,
+    Red::ERTDBFlatType::CName,
+    Red::ERTDBFlatType::String,
+    Red::ERTDBFlatType::TweakDBIDArray,
+    Red::ERTDBFlatType::FloatArray,
+};
+}
+
+Bench::MemoryTweakDB::MemoryTweakDB(Options aOptions)
+    : m_options(aOptions)
+    , m_tweakDb(Core::MakeUnique<Red::TweakDB>())
+    , m_buffer(nullptr)
+{
+    CreateBuffer();
+    CreateFlats();
+}
+
+Bench::MemoryTweakDB::~MemoryTweakDB()
+{
+    // The values are left as they are, only the memory of the buffer is owned by the stand-in
+    m_tweakDb->flatDataBuffer = 0;
+    m_tweakDb->flatDataBufferEnd = 0;
+    m_tweakDb->flatDataBufferCapacity = 0;
+
+    ::operator delete[](m_buffer, BufferAlignment);
+}
+
+void Bench::MemoryTweakDB::CreateBuffer()
+{
+    // The buffer is never grown, so the capacity must fit the seeded values and all workloads
+    m_buffer = static_cast<uint8_t*>(::operator new[](m_options.bufferCapacity, BufferAlignment));
+    std::memset(m_buffer, 0, m_options.bufferCapacity);
+
+    m_tweakDb->flatDataBuffer = reinterpret_cast<uintptr_t>(m_buffer);
+    m_tweakDb->flatDataBufferEnd = m_tweakDb->flatDataBuffer;
+    m_tweakDb->flatDataBufferCapacity =
+        static_cast<decltype(m_tweakDb->flatDataBufferCapacity)>(m_options.bufferCapacity);
+}
+
+void Bench::MemoryTweakDB::CreateFlats()
+{
+    Core::Vector<Red::TweakDBID> flats;
+    flats.reserve(m_options.flats);
+
+    for (uint32_t i = 0; i < m_options.flats; ++i)
+    {
+        auto flatId = Red::TweakDBID(std::format("{}{}.prop{}", FlatNamePrefix, i / FlatsPerRecord,
+                                                 i % FlatsPerRecord));
+        flatId.SetTDBOffset(CreateValue(i));
+
+        flats.push_back(flatId);
+    }
+
+    std::sort(flats.begin(), flats.end());
+
+    std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+    m_tweakDb->flats.Reserve(static_cast<uint32_t>(flats.size()));
+    std::copy(flats.begin(), flats.end(), m_tweakDb->flats.entries);
+    m_tweakDb->flats.size = static_cast<uint32_t>(flats.size());
+}
+
+int32_t Bench::MemoryTweakDB::CreateValue(uint32_t aIndex)
+{
+    // The values repeat after the unique count, so the blob has duplicates to skip like the game blob
+    const auto typeName = Red::CName(FlatTypes[aIndex % std::size(FlatTypes)]);
+    const auto valueIndex = aIndex % std::max(m_options.uniqueValues, 1u);
+    const auto value = Red::MakeValue(typeName);
+
+    switch (typeName.hash)
+    {
+    case Red::ERTDBFlatType::Int:
+        *reinterpret_cast<int32_t*>(value->instance) = static_cast<int32_t>(valueIndex);
+        break;
+    case Red::ERTDBFlatType::Float:
+        *reinterpret_cast<float*>(value->instance) = static_cast<float>(valueIndex) * 0.25f;
+        break;
+    case Red::ERTDBFlatType::Bool:
+        *reinterpret_cast<bool*>(value->instance) = valueIndex % 2 == 0;
+        break;
+    case Red::ERTDBFlatType::TweakDBID:
+        *reinterpret_cast<Red::TweakDBID*>(value->instance) = Red::TweakDBID(
+            std::format("{}{}", FlatNamePrefix, valueIndex / FlatsPerRecord));
+        break;
+    case Red::ERTDBFlatType::CName:
+        *reinterpret_cast<Red::CName*>(value->instance) = Red::CName(
+            std::format("BenchName{}", valueIndex).c_str());
+        break;
+    case Red::ERTDBFlatType::String:
+        *reinterpret_cast<Red::CString*>(value->instance) = std::format("Bench string {}", valueIndex).c_str();
+        break;
+    case Red::ERTDBFlatType::TweakDBIDArray:
+    {
+        auto* array = reinterpret_cast<Red::DynArray<Red::TweakDBID>*>(value->instance);
+        for (uint32_t i = 0; i < valueIndex % FlatsPerRecord; ++i)
+        {
+            array->PushBack(Red::TweakDBID(std::format("{}{}", FlatNamePrefix, valueIndex / FlatsPerRecord + i)));
+        }
+        break;
+    }
+    case Red::ERTDBFlatType::FloatArray:
+    {
+        auto* array = reinterpret_cast<Red::DynArray<float>*>(value->instance);
+        for (uint32_t i = 0; i < valueIndex % FlatsPerRecord; ++i)
+        {
+            array->PushBack(static_cast<float>(valueIndex + i));
+        }
+        break;
+    }
+    }
+
+    return m_tweakDb->CreateFlatValue(*value);
+}
+
+Red::TweakDB* Bench::MemoryTweakDB::GetTweakDB()
+{
+    return m_tweakDb.get();
+}
+
+Core::Vector<Red::TweakDBID> Bench::MemoryTweakDB::SampleFlats(uint32_t aCount)
+{
+    Core::Vector<Red::TweakDBID> samples;
+
+    if (aCount == 0)
+        return samples;
+
+    samples.reserve(aCount);
+
+    std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+    const auto step = std::max(1u, m_tweakDb->flats.size / aCount);
+    for (uint32_t i = 0; i < m_tweakDb->flats.size && samples.size() < aCount; i += step)
+    {
+        samples.push_back(m_tweakDb->flats.entries[i]);
+    }
+
+    return samples;
+}
+
+void Bench::MemoryTweakDB::CopyFlats(Red::SortedUniqueArray<Red::TweakDBID>& aFlats)
+{
+    std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+    aFlats.Clear();
+    aFlats.Reserve(m_tweakDb->flats.size);
+
+    std::copy(m_tweakDb->flats.Begin(), m_tweakDb->flats.End(), aFlats.entries);
+    aFlats.size = m_tweakDb->flats.size;
+}
+
+uint32_t Bench::MemoryTweakDB::GetFlatCount()
+{
+    std::shared_lock flatLockR(m_tweakDb->mutex00);
+    return m_tweakDb->flats.size;
+}
+
+size_t Bench::MemoryTweakDB::GetBufferSize()
+{
+    return m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+}
+
+size_t Bench::MemoryTweakDB::GetBufferCapacity()
+{
+    return m_options.bufferCapacity;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Bench/Database/TweakDBStandIn.hpp"
+
+namespace Bench
+{
+// Database that only exists in memory of the benchmark.
+//
+// It's seeded with synthetic flats of the common flat types, including duplicate values like in the game blob.
+// Records are created by the workloads, the record types must be imported into the reflection from a schema.
+// The flat values are created by the game routines, so the stand-in still needs the game runtime,
+// but nothing is ever written to the game database.
+class MemoryTweakDB : public TweakDBStandIn
+{
+public:
+    struct Options
+    {
+        uint32_t flats = 500000;
+        uint32_t uniqueValues = 400000;
+        size_t bufferCapacity = 128 * 1024 * 1024; // bytes
+    };
+
+    explicit MemoryTweakDB(Options aOptions = {});
+    ~MemoryTweakDB() override;
+
+    MemoryTweakDB(const MemoryTweakDB&) = delete;
+    MemoryTweakDB& operator=(const MemoryTweakDB&) = delete;
+
+    Red::TweakDB* GetTweakDB() override;
+    Core::Vector<Red::TweakDBID> SampleFlats(uint32_t aCount) override;
+    void CopyFlats(Red::SortedUniqueArray<Red::TweakDBID>& aFlats) override;
+    uint32_t GetFlatCount() override;
+    size_t GetBufferSize() override;
+    size_t GetBufferCapacity() override;
+
+private:
+    void CreateBuffer();
+    void CreateFlats();
+    int32_t CreateValue(uint32_t aIndex);
+
+    Options m_options;
+    Core::UniquePtr<Red::TweakDB> m_tweakDb;
+    uint8_t* m_buffer;
+};
+}
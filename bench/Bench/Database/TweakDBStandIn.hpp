@@ -0,0 +1,24 @@
+#pragma once
+
+namespace Bench
+{
+// Database the workloads run against, the benchmarks never access the game database directly.
+class TweakDBStandIn
+{
+public:
+    virtual ~TweakDBStandIn() = default;
+
+    // Database instance for the components under test.
+    virtual Red::TweakDB* GetTweakDB() = 0;
+
+    // Returns up to the given number of existing flats, evenly spaced over the sorted flats.
+    virtual Core::Vector<Red::TweakDBID> SampleFlats(uint32_t aCount) = 0;
+
+    // Copies all existing flats into the given array.
+    virtual void CopyFlats(Red::SortedUniqueArray<Red::TweakDBID>& aFlats) = 0;
+
+    virtual uint32_t GetFlatCount() = 0;
+    virtual size_t GetBufferSize() = 0; // bytes
+    virtual size_t GetBufferCapacity() = 0; // bytes
+};
+}
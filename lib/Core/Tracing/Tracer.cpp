@@ -0,0 +1,161 @@
+#include "Tracer.hpp"
+#include "Core/Stl.hpp"
+
+namespace
+{
+struct TraceEvent
+{
+    std::string name;
+    std::string category;
+    std::string detail;
+    Core::Tracer::Clock::time_point start;
+    Core::Tracer::Clock::time_point end;
+    uint32_t threadId;
+};
+
+std::atomic_bool s_enabled;
+std::mutex s_mutex;
+Core::Vector<TraceEvent> s_events;
+Core::Tracer::Clock::time_point s_origin;
+std::atomic_uint32_t s_nextThreadId;
+
+uint32_t GetThreadId()
+{
+    thread_local const uint32_t s_threadId = ++s_nextThreadId;
+    return s_threadId;
+}
+
+void WriteString(std::ostream& aOut, std::string_view aValue)
+{
+    aOut << '"';
+
+    for (const auto c : aValue)
+    {
+        switch (c)
+        {
+        case '"': aOut << "\\\""; break;
+        case '\\': aOut << "\\\\"; break;
+        case '\n': aOut << "\\n"; break;
+        case '\r': aOut << "\\r"; break;
+        case '\t': aOut << "\\t"; break;
+        default:
+        {
+            if (static_cast<uint8_t>(c) < 0x20)
+                aOut << std::format("\\u{:04x}", static_cast<uint8_t>(c));
+            else
+                aOut << c;
+        }
+        }
+    }
+
+    aOut << '"';
+}
+}
+
+void Core::Tracer::Enable()
+{
+    std::unique_lock lock(s_mutex);
+
+    if (!s_enabled)
+    {
+        s_origin = Clock::now();
+        s_enabled = true;
+    }
+}
+
+void Core::Tracer::Disable()
+{
+    s_enabled = false;
+}
+
+bool Core::Tracer::IsEnabled()
+{
+    return s_enabled;
+}
+
+void Core::Tracer::Record(std::string_view aName, std::string_view aCategory, std::string_view aDetail,
+                          Clock::time_point aStart, Clock::time_point aEnd)
+{
+    if (!s_enabled)
+        return;
+
+    const auto threadId = GetThreadId();
+
+    std::unique_lock lock(s_mutex);
+    s_events.push_back({std::string(aName), std::string(aCategory), std::string(aDetail), aStart, aEnd, threadId});
+}
+
+void Core::Tracer::Clear()
+{
+    std::unique_lock lock(s_mutex);
+    s_events.clear();
+}
+
+bool Core::Tracer::Export(const std::filesystem::path& aPath)
+{
+    std::unique_lock lock(s_mutex);
+
+    std::ofstream out(aPath, std::ios::out | std::ios::trunc);
+
+    if (!out.is_open())
+        return false;
+
+    out << "{\"traceEvents\":[";
+
+    auto first = true;
+
+    for (const auto& event : s_events)
+    {
+        const auto start = std::chrono::duration_cast<std::chrono::microseconds>(event.start - s_origin).count();
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(event.end - event.start).count();
+
+        out << (first ? "\n" : ",\n");
+        out << "{\"name\":";
+        WriteString(out, event.name);
+        out << ",\"cat\":";
+        WriteString(out, event.category);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId;
+        out << ",\"ts\":" << start << ",\"dur\":" << duration;
+
+        if (!event.detail.empty())
+        {
+            out << ",\"args\":{\"detail\":";
+            WriteString(out, event.detail);
+            out << "}";
+        }
+
+        out << "}";
+
+        first = false;
+    }
+
+    out << "\n]}\n";
+
+    return out.good();
+}
+
+Core::TraceSpan::TraceSpan(std::string_view aName, std::string_view aCategory, std::string_view aDetail)
+    : m_active(Tracer::IsEnabled())
+{
+    if (m_active)
+    {
+        m_name = aName;
+        m_category = aCategory;
+        m_detail = aDetail;
+        m_start = Tracer::Clock::now();
+    }
+}
+
+Core::TraceSpan::~TraceSpan()
+{
+    End();
+}
+
+void Core::TraceSpan::End()
+{
+    if (m_active)
+    {
+        Tracer::Record(m_name, m_category, m_detail, m_start, Tracer::Clock::now());
+        m_active = false;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+namespace Core
+{
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static void Enable();
+    static void Disable();
+    static bool IsEnabled();
+
+    static void Record(std::string_view aName, std::string_view aCategory, std::string_view aDetail,
+                       Clock::time_point aStart, Clock::time_point aEnd);
+    static void Clear();
+
+    // Writes the recorded spans in Chrome trace event format,
+    // the result can be opened in chrome://tracing or Perfetto.
+    static bool Export(const std::filesystem::path& aPath);
+};
+
+class TraceSpan
+{
+public:
+    explicit TraceSpan(std::string_view aName, std::string_view aCategory = {}, std::string_view aDetail = {});
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    void End();
+
+private:
+    std::string m_name;
+    std::string m_category;
+    std::string m_detail;
+    Tracer::Clock::time_point m_start;
+    bool m_active;
+};
+}
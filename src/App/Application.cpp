@@ -5,13 +5,22 @@
 #include "App/Stats/StatService.hpp"
 #include "App/Tweaks/TweakService.hpp"
 #include "Core/Foundation/RuntimeProvider.hpp"
+#include "Core/Tracing/Tracer.hpp"
 #include "Support/MinHook/MinHookProvider.hpp"
 #include "Support/RED4ext/RED4extProvider.hpp"
 #include "Support/RedLib/RedLibProvider.hpp"
 #include "Support/Spdlog/SpdlogProvider.hpp"
 
+#ifdef BENCH
+#include "Bench/BenchmarkService.hpp"
+#endif
+
 App::Application::Application(HMODULE aHandle, const RED4ext::Sdk* aSdk)
 {
+#ifdef TRACE
+    Core::Tracer::Enable();
+#endif
+
     Register<Core::RuntimeProvider>(aHandle)
         ->SetBaseImagePathDepth(2);
 
@@ -26,8 +35,17 @@ App::Application::Application(HMODULE aHandle, const RED4ext::Sdk* aSdk)
 
     Register<App::TweakService>(Env::GameVer(), Env::GameDir(), Env::TweaksDir(),
                                 Env::InheritanceMapPath(), Env::ExtraFlatsPath(),
-                                Env::RedModSourcesDir());
+                                Env::RedModSourcesDir())
+        ->EnableImportCache(Env::TweakCachePath())
+        ->EnableSchemaCache(Env::SchemaCachePath())
+        ->EnableIncrementalReload()
+        ->EnableRecordWarmUp()
+        ->SetTracePath(Env::TracePath());
     Register<App::StatService>();
+
+#ifdef BENCH
+    Register<Bench::BenchmarkService>(Env::BenchReportPath());
+#endif
 }
 
 void App::Application::OnStarting()
@@ -49,6 +49,26 @@ inline auto InheritanceMapPath()
     return PluginDataDir() / L"InheritanceMap.dat";
 }
 
+inline auto TracePath()
+{
+    return Core::Runtime::GetModulePath().replace_extension(L".trace.json");
+}
+
+inline auto BenchReportPath()
+{
+    return Core::Runtime::GetModulePath().replace_extension(L".bench.json");
+}
+
+inline auto TweakCachePath()
+{
+    return PluginDir() / L"Cache" / L"Tweaks.dat";
+}
+
+inline auto SchemaCachePath()
+{
+    return PluginDir() / L"Cache" / L"Schema.dat";
+}
+
 inline const auto& GameVer()
 {
     return Core::Runtime::GetHost()->GetProductVer();
@@ -46,7 +46,12 @@ void App::Facade::ExportMetadata()
 
 void App::Facade::Reload()
 {
-    Core::Resolve<TweakService>()->LoadTweaks(true);
+    Core::Resolve<TweakService>()->ReloadTweaks();
+}
+
+void App::Facade::CompactBuffer()
+{
+    Core::Resolve<TweakService>()->CompactBuffer();
 }
 
 bool App::Facade::Require(Red::CString& aVersion)
@@ -16,6 +16,7 @@ public:
     static void ExecuteTweak(Red::CName aName);
     static void ExportMetadata();
     static void Reload();
+    static void CompactBuffer();
     static bool Require(Red::CString& aVersion);
     static Red::CString GetVersion();
 
@@ -34,6 +35,7 @@ RTTI_DEFINE_CLASS(App::Facade, App::Project::Name, {
     RTTI_METHOD(ExecuteTweak, "Execute");
     RTTI_METHOD(ExportMetadata);
     RTTI_METHOD(Reload);
+    RTTI_METHOD(CompactBuffer);
     RTTI_METHOD(Require);
     RTTI_METHOD(GetVersion, "Version");
 })
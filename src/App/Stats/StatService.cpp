@@ -30,6 +30,12 @@ void App::StatService::RegisterStats(void* aStatSystem, const Core::Set<Red::Twe
 
     auto& tweakManager = Core::Resolve<TweakService>()->GetManager();
 
+    // Resolve the unknown names at once instead of one by one in the loop
+    {
+        Core::Vector<Red::TweakDBID> recordIDs(aRecordIDs.begin(), aRecordIDs.end());
+        tweakManager.ResolveNames(recordIDs);
+    }
+
     for (const auto& recordID : aRecordIDs)
     {
         const auto& recordName = tweakManager.GetName(recordID);
@@ -11,17 +11,23 @@ bool App::TweakChangelog::RegisterRecord(Red::TweakDBID aRecordId)
     return true;
 }
 
-bool App::TweakChangelog::RegisterAssignment(Red::TweakDBID aFlatId, Red::Instance aOldValue, Red::Instance aNewValue)
+bool App::TweakChangelog::RegisterAssignment(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType,
+                                             Red::Instance aOldValue, Red::Instance aNewValue)
 {
-    if (!aFlatId.IsValid() || !aOldValue || !aNewValue || aOldValue == aNewValue)
+    if (!aFlatId.IsValid() || !aType || !aOldValue || !aNewValue || aOldValue == aNewValue)
         return false;
 
     aFlatId.SetTDBOffset(0);
     m_ownedKeys.insert(aFlatId);
 
     auto& entry = m_assignments[aFlatId];
-    entry.previous = aOldValue;
-    entry.current = aNewValue;
+    entry.current = Red::MakeValue(aType, aNewValue);
+
+    // Keep the original value if the flat is reassigned on top of previous changes
+    if (!entry.previous)
+    {
+        entry.previous = Red::MakeValue(aType, aOldValue);
+    }
 
     return false;
 }
@@ -64,6 +70,61 @@ void App::TweakChangelog::ForgetChanges(Red::TweakDBID aFlatId)
     m_mutations.erase(aFlatId);
 }
 
+bool App::TweakChangelog::CanRevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                              Red::TweakDBID aFlatId)
+{
+    if (!aFlatId.IsValid())
+        return false;
+
+    aFlatId.SetTDBOffset(0);
+
+    const auto it = m_assignments.find(aFlatId);
+
+    if (it == m_assignments.end())
+        return false;
+
+    const auto flatData = aManager->GetFlat(aFlatId);
+
+    if (!flatData.instance)
+    {
+        LogWarning("Cannot restore {}, the flat doesn't exist.", aManager->GetName(aFlatId));
+        return false;
+    }
+
+    if (flatData.type != it->second.previous->type)
+    {
+        LogWarning("Cannot restore {}, the flat type has changed.", aManager->GetName(aFlatId));
+        return false;
+    }
+
+    return true;
+}
+
+bool App::TweakChangelog::RevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                           Red::TweakDBID aFlatId)
+{
+    if (!CanRevertAssignment(aManager, aFlatId))
+        return false;
+
+    aFlatId.SetTDBOffset(0);
+
+    const auto it = m_assignments.find(aFlatId);
+    const auto& previous = it->second.previous;
+
+    const auto success = aManager->SetFlat(aFlatId, previous->type, previous->instance);
+
+    if (!success)
+    {
+        LogError("Cannot restore {}, failed to assign the value.", aManager->GetName(aFlatId));
+        return false;
+    }
+
+    m_assignments.erase(it);
+    m_ownedKeys.erase(aFlatId);
+
+    return true;
+}
+
 void App::TweakChangelog::RegisterForeignKey(Red::TweakDBID aForeignKey, Red::TweakDBID aFlatId)
 {
     if (aForeignKey.IsValid())
@@ -106,6 +167,25 @@ void App::TweakChangelog::ForgetResourcePaths()
     m_resourcePaths.clear();
 }
 
+void App::TweakChangelog::ForgetReferences(Red::TweakDBID aFlatId)
+{
+    for (auto it = m_foreignKeys.begin(); it != m_foreignKeys.end();)
+    {
+        if (it->second == aFlatId)
+            it = m_foreignKeys.erase(it);
+        else
+            ++it;
+    }
+
+    for (auto it = m_resourcePaths.begin(); it != m_resourcePaths.end();)
+    {
+        if (it->second == aFlatId)
+            it = m_resourcePaths.erase(it);
+        else
+            ++it;
+    }
+}
+
 void App::TweakChangelog::CheckForIssues(const Core::SharedPtr<Red::TweakDBManager>& aManager)
 {
     {
@@ -249,13 +329,14 @@ void App::TweakChangelog::RevertChanges(const Core::SharedPtr<Red::TweakDBManage
             continue;
         }
 
-        if (!m_ownedKeys.contains(flatId) && flatData.instance != assignment.current)
+        if (flatData.type != assignment.previous->type ||
+            (!m_ownedKeys.contains(flatId) && !flatData.type->IsEqual(flatData.instance, assignment.current->instance)))
         {
             LogWarning("Cannot restore {}, third party changes detected.", aManager->GetName(flatId));
             continue;
         }
 
-        const auto success = aManager->SetFlat(flatId, flatData.type, assignment.previous);
+        const auto success = aManager->SetFlat(flatId, flatData.type, assignment.previous->instance);
 
         if (!success)
         {
@@ -264,11 +345,10 @@ void App::TweakChangelog::RevertChanges(const Core::SharedPtr<Red::TweakDBManage
         }
     }
 
-    for (const auto recordId : m_records)
     {
-        const auto success = aManager->UpdateRecord(recordId);
+        const Core::Vector<Red::TweakDBID> recordIds(m_records.begin(), m_records.end());
 
-        if (!success)
+        for (const auto& recordId : aManager->UpdateRecords(recordIds).failed)
         {
             LogError("Cannot restore {}, failed to update the record.", aManager->GetName(recordId));
         }
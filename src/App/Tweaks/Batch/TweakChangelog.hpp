@@ -10,10 +10,13 @@ class TweakChangelog : public Core::LoggingAgent
 public:
     bool RegisterRecord(Red::TweakDBID aRecordId);
 
-    bool RegisterAssignment(Red::TweakDBID aFlatId, Red::Instance aOldValue, Red::Instance aNewValue);
+    bool RegisterAssignment(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aOldValue,
+                            Red::Instance aNewValue);
     bool RegisterInsertion(Red::TweakDBID aFlatId, int32_t aIndex, const Red::InstancePtr<>& aInstance);
     bool RegisterDeletion(Red::TweakDBID aFlatId, int32_t aIndex, const Red::InstancePtr<>& aInstance);
     void ForgetChanges(Red::TweakDBID aFlatId);
+    bool CanRevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId);
+    bool RevertAssignment(const Core::SharedPtr<Red::TweakDBManager>& aManager, Red::TweakDBID aFlatId);
 
     void RegisterForeignKey(Red::TweakDBID aForeignKey, Red::TweakDBID aFlatId);
     void ForgetForeignKey(Red::TweakDBID aForeignKey);
@@ -22,6 +25,7 @@ public:
     void RegisterResourcePath(Red::ResourcePath aPath, Red::TweakDBID aFlatId);
     void ForgetResourcePath(Red::ResourcePath aPath);
     void ForgetResourcePaths();
+    void ForgetReferences(Red::TweakDBID aFlatId);
 
     void CheckForIssues(const Core::SharedPtr<Red::TweakDBManager>& aManager);
     void RevertChanges(const Core::SharedPtr<Red::TweakDBManager>& aManager);
@@ -29,10 +33,11 @@ public:
     [[nodiscard]] const Core::Set<Red::TweakDBID>& GetAffectedRecords() const;
 
 private:
+    // The values are copied out of the flat buffer, since compaction can move or release them.
     struct AssignmentEntry
     {
-        Red::Instance previous;
-        Red::Instance current;
+        Red::ValuePtr<> previous;
+        Red::ValuePtr<> current;
     };
 
     struct MutationEntry
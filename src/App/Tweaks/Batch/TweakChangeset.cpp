@@ -1,4 +1,54 @@
 #include "TweakChangeset.hpp"
+#include "Core/Tracing/Tracer.hpp"
+
+namespace
+{
+constexpr auto MinFlatsPerJob = 4096u;
+
+// Hands out the flat chunks of a commit to the committing thread and the helper jobs.
+struct FlatChunkQueue
+{
+    explicit FlatChunkQueue(size_t aSize)
+        : size(aSize)
+    {
+    }
+
+    bool Claim(size_t& aIndex)
+    {
+        std::unique_lock _(mutex);
+
+        if (next == size)
+            return false;
+
+        aIndex = next++;
+        ++running;
+
+        return true;
+    }
+
+    void Release()
+    {
+        std::unique_lock _(mutex);
+
+        if (--running == 0 && next == size)
+        {
+            finished.notify_all();
+        }
+    }
+
+    void WaitRunning()
+    {
+        std::unique_lock lock(mutex);
+        finished.wait(lock, [this]() { return running == 0; });
+    }
+
+    const size_t size;
+    size_t next{0};
+    size_t running{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+}
 
 bool App::TweakChangeset::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType,
                                   const Red::InstancePtr<>& aValue)
@@ -10,6 +60,11 @@ bool App::TweakChangeset::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTITy
     entry.type = aType;
     entry.value = aValue;
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::SetFlat, .targetId = aFlatId, .type = aType, .value = aValue});
+    }
+
     return true;
 }
 
@@ -22,6 +77,12 @@ bool App::TweakChangeset::ReinheritFlat(Red::TweakDBID aFlatId, Red::TweakDBID a
     entry.sourceId = aSourceId;
     entry.appendix = aAppendix;
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::ReinheritFlat, .targetId = aFlatId, .sourceId = aSourceId,
+                         .text = aAppendix});
+    }
+
     return true;
 }
 
@@ -41,6 +102,12 @@ bool App::TweakChangeset::MakeRecord(Red::TweakDBID aRecordId, const Red::CClass
         m_orderedRecords.push_back(aRecordId);
     }
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::MakeRecord, .targetId = aRecordId, .sourceId = aSourceId,
+                         .type = aType});
+    }
+
     return true;
 }
 
@@ -55,6 +122,11 @@ bool App::TweakChangeset::UpdateRecord(Red::TweakDBID aRecordId)
         m_orderedRecords.push_back(aRecordId);
     }
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::UpdateRecord, .targetId = aRecordId});
+    }
+
     return true;
 }
 
@@ -67,6 +139,12 @@ bool App::TweakChangeset::AppendElement(Red::TweakDBID aFlatId, const Red::CBase
     auto& entry = m_pendingMutations[aFlatId];
     entry.appendings.emplace_back(aType, aValue, aUnique);
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::AppendElement, .targetId = aFlatId, .type = aType,
+                         .value = aValue, .unique = aUnique});
+    }
+
     return true;
 }
 
@@ -79,6 +157,12 @@ bool App::TweakChangeset::PrependElement(Red::TweakDBID aFlatId, const Red::CBas
     auto& entry = m_pendingMutations[aFlatId];
     entry.prependings.emplace_back(aType, aValue, aUnique);
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::PrependElement, .targetId = aFlatId, .type = aType,
+                         .value = aValue, .unique = aUnique});
+    }
+
     return true;
 }
 
@@ -91,6 +175,12 @@ bool App::TweakChangeset::RemoveElement(Red::TweakDBID aFlatId, const Red::CBase
     auto& entry = m_pendingMutations[aFlatId];
     entry.deletions.emplace_back(aType, aValue);
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::RemoveElement, .targetId = aFlatId, .type = aType,
+                         .value = aValue});
+    }
+
     return true;
 }
 
@@ -102,6 +192,11 @@ bool App::TweakChangeset::RemoveAllElements(Red::TweakDBID aFlatId)
     auto& entry = m_pendingMutations[aFlatId];
     entry.deleteAll = true;
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::RemoveAllElements, .targetId = aFlatId});
+    }
+
     return true;
 }
 
@@ -113,6 +208,11 @@ bool App::TweakChangeset::AppendFrom(Red::TweakDBID aFlatId, Red::TweakDBID aSou
     auto& entry = m_pendingMutations[aFlatId];
     entry.appendingMerges.emplace_back(aSourceId);
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::AppendFrom, .targetId = aFlatId, .sourceId = aSourceId});
+    }
+
     return true;
 }
 
@@ -124,6 +224,11 @@ bool App::TweakChangeset::PrependFrom(Red::TweakDBID aFlatId, Red::TweakDBID aSo
     auto& entry = m_pendingMutations[aFlatId];
     entry.prependingMerges.emplace_back(aSourceId);
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::PrependFrom, .targetId = aFlatId, .sourceId = aSourceId});
+    }
+
     return true;
 }
 
@@ -131,6 +236,11 @@ bool App::TweakChangeset::RegisterName(Red::TweakDBID aId, const std::string& aN
 {
     m_pendingNames[aId] = aName;
 
+    if (m_recording)
+    {
+        RecordOperation({.operation = EOperation::RegisterName, .targetId = aId, .text = aName});
+    }
+
     return true;
 }
 
@@ -138,6 +248,11 @@ const App::TweakChangeset::FlatEntry* App::TweakChangeset::GetFlat(Red::TweakDBI
 {
     const auto it = m_pendingFlats.find(aFlatId);
 
+    if (m_recording)
+    {
+        RecordDependency(EDependency::Flat, aFlatId, it != m_pendingFlats.end() ? it->second.type : nullptr);
+    }
+
     if (it == m_pendingFlats.end())
         return nullptr;
 
@@ -148,6 +263,11 @@ const App::TweakChangeset::RecordEntry* App::TweakChangeset::GetRecord(Red::Twea
 {
     const auto it = m_pendingRecords.find(aRecordId);
 
+    if (m_recording)
+    {
+        RecordDependency(EDependency::Record, aRecordId, it != m_pendingRecords.end() ? it->second.type : nullptr);
+    }
+
     if (it == m_pendingRecords.end())
         return nullptr;
 
@@ -169,20 +289,194 @@ bool App::TweakChangeset::HasRecord(Red::TweakDBID aRecordId)
     return m_pendingRecords.find(aRecordId) != m_pendingRecords.end();
 }
 
+const Red::CBaseRTTIType* App::TweakChangeset::GetBaseFlatType(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                                               Red::TweakDBID aFlatId)
+{
+    const auto flat = aManager->GetFlat(aFlatId);
+    const auto* type = flat.instance ? flat.type : nullptr;
+
+    if (m_recording)
+    {
+        RecordDependency(EDependency::BaseFlat, aFlatId, type);
+    }
+
+    return type;
+}
+
+const Red::CClass* App::TweakChangeset::GetBaseRecordType(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                                          Red::TweakDBID aRecordId)
+{
+    const auto* type = aManager->GetRecordType(aRecordId);
+
+    if (m_recording)
+    {
+        RecordDependency(EDependency::BaseRecord, aRecordId, type);
+    }
+
+    return type;
+}
+
 bool App::TweakChangeset::IsEmpty()
 {
     return m_pendingFlats.empty() && m_pendingRecords.empty() && m_pendingMutations.empty() && m_pendingNames.empty();
 }
 
+void App::TweakChangeset::StartRecording()
+{
+    m_recording = Core::MakeShared<Recording>();
+    m_recordedIds.clear();
+    m_recordedBaseIds.clear();
+}
+
+App::TweakChangeset::RecordingPtr App::TweakChangeset::FinishRecording()
+{
+    m_recordedIds.clear();
+    m_recordedBaseIds.clear();
+
+    return std::move(m_recording);
+}
+
+bool App::TweakChangeset::CanReplay(const Recording& aRecording,
+                                    const Core::SharedPtr<Red::TweakDBManager>& aManager)
+{
+    for (const auto& dependency : aRecording.dependencies)
+    {
+        switch (dependency.kind)
+        {
+        case EDependency::Flat:
+        {
+            const auto it = m_pendingFlats.find(dependency.id);
+            const auto* type = it != m_pendingFlats.end() ? it->second.type : nullptr;
+
+            if (type != dependency.type)
+                return false;
+
+            break;
+        }
+        case EDependency::Record:
+        {
+            const auto it = m_pendingRecords.find(dependency.id);
+            const auto* type = it != m_pendingRecords.end() ? it->second.type : nullptr;
+
+            if (type != dependency.type)
+                return false;
+
+            break;
+        }
+        case EDependency::BaseFlat:
+        {
+            const auto flat = aManager->GetFlat(dependency.id);
+            const auto* type = flat.instance ? flat.type : nullptr;
+
+            if (type != dependency.type)
+                return false;
+
+            break;
+        }
+        case EDependency::BaseRecord:
+        {
+            if (aManager->GetRecordType(dependency.id) != dependency.type)
+                return false;
+
+            break;
+        }
+        }
+    }
+
+    return true;
+}
+
+void App::TweakChangeset::Replay(const Recording& aRecording)
+{
+    for (const auto& entry : aRecording.operations)
+    {
+        switch (entry.operation)
+        {
+        case EOperation::SetFlat:
+            SetFlat(entry.targetId, entry.type, entry.value);
+            break;
+        case EOperation::ReinheritFlat:
+            ReinheritFlat(entry.targetId, entry.sourceId, entry.text);
+            break;
+        case EOperation::MakeRecord:
+            MakeRecord(entry.targetId, reinterpret_cast<const Red::CClass*>(entry.type), entry.sourceId);
+            break;
+        case EOperation::UpdateRecord:
+            UpdateRecord(entry.targetId);
+            break;
+        case EOperation::AppendElement:
+            AppendElement(entry.targetId, entry.type, entry.value, entry.unique);
+            break;
+        case EOperation::PrependElement:
+            PrependElement(entry.targetId, entry.type, entry.value, entry.unique);
+            break;
+        case EOperation::RemoveElement:
+            RemoveElement(entry.targetId, entry.type, entry.value);
+            break;
+        case EOperation::RemoveAllElements:
+            RemoveAllElements(entry.targetId);
+            break;
+        case EOperation::AppendFrom:
+            AppendFrom(entry.targetId, entry.sourceId);
+            break;
+        case EOperation::PrependFrom:
+            PrependFrom(entry.targetId, entry.sourceId);
+            break;
+        case EOperation::RegisterName:
+            RegisterName(entry.targetId, entry.text);
+            break;
+        }
+    }
+}
+
+void App::TweakChangeset::RecordOperation(OperationEntry&& aEntry)
+{
+    switch (aEntry.operation)
+    {
+    case EOperation::SetFlat:
+    case EOperation::MakeRecord:
+    case EOperation::UpdateRecord:
+        m_recordedIds.insert(aEntry.targetId);
+        break;
+    default:
+        break;
+    }
+
+    m_recording->operations.push_back(std::move(aEntry));
+}
+
+void App::TweakChangeset::RecordDependency(EDependency aKind, Red::TweakDBID aId, const Red::CBaseRTTIType* aType)
+{
+    // The database doesn't change while the sources are read, so each entry is only recorded once
+    if (aKind == EDependency::BaseFlat || aKind == EDependency::BaseRecord)
+    {
+        if (!m_recordedBaseIds.insert(aId).second)
+            return;
+    }
+    // Lookups of the entries produced by the recorded source itself
+    // will produce the same result on replay and can be skipped.
+    else if (m_recordedIds.contains(aId))
+    {
+        return;
+    }
+
+    m_recording->dependencies.push_back({aKind, aId, aType});
+}
+
 void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aManager,
-                                 const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+                                 const Core::SharedPtr<App::TweakChangelog>& aChangelog, bool aRevertChanges)
 {
     if (!aManager || !IsCommitFinished())
         return;
 
     StartCommitJob();
 
-    if (aChangelog)
+    {
+        std::lock_guard _(m_commitMutex);
+        m_commitGuard = aManager->StartCommit();
+    }
+
+    if (aChangelog && aRevertChanges)
     {
         aChangelog->RevertChanges(aManager);
         aChangelog->ForgetForeignKeys();
@@ -192,6 +486,8 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
     if (!m_pendingNames.empty())
     {
         StartAsyncCommitJob([&]() {
+            Core::TraceSpan span("Registering names", "Commit");
+
             for (const auto& [id, name] : m_pendingNames)
             {
                 aManager->RegisterName(id, name, GetRecordType(id));
@@ -201,6 +497,8 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
 
     LogDebug("Resolving inheritance...");
 
+    Core::TraceSpan inheritanceSpan("Resolving inheritance", "Commit");
+
     if (!m_reinheritedProps.empty())
     {
         Core::Set<Red::TweakDBID> convertedToMutation;
@@ -376,8 +674,12 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
         }
     }
 
+    inheritanceSpan.End();
+
     LogDebug("Resolving mutations...");
 
+    Core::TraceSpan mutationSpan("Resolving mutations", "Commit");
+
     for (const auto& [flatId, mutation] : m_pendingMutations)
     {
         if (!mutation.deleteAll)
@@ -406,9 +708,13 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
         const_cast<MutationEntry&>(mutation).deleteAll = false;
     }
 
+    mutationSpan.End();
+
     {
         LogDebug("Preparing records...");
 
+        Core::TraceSpan span("Creating records", "Commit");
+
         const auto batch = aManager->StartBatch();
 
         for (const auto& recordId : m_orderedRecords)
@@ -433,58 +739,18 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
 
         LogDebug("Committing changes...");
 
-        aManager->CommitBatch(batch);
+        // The records are built once in the end, when all flats have their final values
+        aManager->CommitBatch(batch, true);
     }
 
     {
         LogDebug("Preparing flats...");
 
-        const auto batch = aManager->StartBatch();
-
-        for (const auto& item : m_pendingFlats)
-        {
-            const auto& flatId = item.first;
-            const auto& flatType = item.second.type;
-            const auto& flatValue = item.second.value.get();
-
-            if (aChangelog)
-            {
-                if (aManager->GetReflection()->IsForeignKey(flatType))
-                {
-                    const auto foreignKey = reinterpret_cast<Red::TweakDBID*>(flatValue);
-                    aChangelog->RegisterForeignKey(*foreignKey, flatId);
-                }
-                else if (aManager->GetReflection()->IsForeignKeyArray(flatType))
-                {
-                    const auto foreignKeyList = reinterpret_cast<Red::DynArray<Red::TweakDBID>*>(flatValue);
-                    for (const auto& foreignKey : *foreignKeyList)
-                    {
-                        aChangelog->RegisterForeignKey(foreignKey, flatId);
-                    }
-                }
-                else if (aManager->GetReflection()->IsResRefToken(flatType))
-                {
-                    const auto resRef = reinterpret_cast<Red::ResourceAsyncReference<>*>(flatValue);
-                    aChangelog->RegisterResourcePath(resRef->path, flatId);
-                }
-                else if (aManager->GetReflection()->IsResRefTokenArray(flatType))
-                {
-                    const auto resRefList = reinterpret_cast<Red::DynArray<Red::ResourceAsyncReference<>>*>(flatValue);
-                    for (const auto& resRef : *resRefList)
-                    {
-                        aChangelog->RegisterResourcePath(resRef.path, flatId);
-                    }
-                }
-            }
+        Core::TraceSpan span("Assigning flats", "Commit");
 
-            const auto success = aManager->SetFlat(batch, flatId, flatType, flatValue);
+        const auto batch = aManager->StartBatch();
 
-            if (!success)
-            {
-                LogError("Can't assign flat {}.", aManager->GetName(flatId));
-                continue;
-            }
-        }
+        AssignFlats(aManager, batch, aChangelog);
 
         for (const auto& recordId : m_orderedRecords)
         {
@@ -519,7 +785,7 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
                     continue;
                 }
 
-                aChangelog->RegisterAssignment(flatId, flatOld.instance, flatNew.instance);
+                aChangelog->RegisterAssignment(flatId, flatNew.type, flatOld.instance, flatNew.instance);
             }
         }
 
@@ -530,6 +796,8 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
 
     LogDebug("Applying mutations...");
 
+    Core::TraceSpan applyingSpan("Applying mutations", "Commit");
+
     for (const auto& [flatId, mutation] : m_pendingMutations)
     {
         auto flatData = aManager->GetFlat(flatId);
@@ -735,19 +1003,167 @@ void App::TweakChangeset::Commit(const Core::SharedPtr<Red::TweakDBManager>& aMa
         }
     }
 
+    applyingSpan.End();
+
     LogDebug("Updating records...");
 
-    for (const auto& recordId : m_orderedRecords)
+    Core::TraceSpan updatingSpan("Updating records", "Commit");
+
+    const auto recordStats = aManager->UpdateRecords(m_orderedRecords);
+
+    for (const auto& recordId : recordStats.failed)
     {
-        const auto success = aManager->UpdateRecord(recordId);
+        LogError("Cannot update record {}.", aManager->GetName(recordId));
+    }
 
-        if (!success)
+    LogDebug("Created {} and updated {} records, {} redundant rebuilds avoided.", recordStats.created,
+             recordStats.updated, recordStats.avoided);
+
+    updatingSpan.End();
+
+    FinishCommitJob();
+}
+
+void App::TweakChangeset::AssignFlats(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                      const Red::TweakDBManager::BatchPtr& aBatch,
+                                      const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    struct FlatChunk
+    {
+        size_t begin;
+        size_t end;
+        Core::Vector<std::pair<Red::TweakDBID, Red::TweakDBID>> foreignKeys;
+        Core::Vector<std::pair<Red::ResourcePath, Red::TweakDBID>> resourcePaths;
+        Core::Vector<Red::TweakDBID> failures;
+    };
+
+    Core::Vector<std::pair<Red::TweakDBID, const FlatEntry*>> flats;
+    flats.reserve(m_pendingFlats.size());
+
+    for (const auto& [flatId, entry] : m_pendingFlats)
+    {
+        flats.emplace_back(flatId, &entry);
+    }
+
+    const auto maxJobs = std::max(std::thread::hardware_concurrency(), 1u);
+    const auto numberOfJobs = std::clamp(static_cast<uint32_t>(flats.size() / MinFlatsPerJob), 1u, maxJobs);
+    const auto flatsPerJob = (flats.size() + numberOfJobs - 1) / numberOfJobs;
+
+    // Chunks are contiguous ranges of the pending flats,
+    // so merging them in order gives the same result as a serial pass.
+    Core::Vector<FlatChunk> chunks(numberOfJobs);
+
+    for (uint32_t i = 0; i < numberOfJobs; ++i)
+    {
+        chunks[i].begin = std::min(i * flatsPerJob, flats.size());
+        chunks[i].end = std::min(chunks[i].begin + flatsPerJob, flats.size());
+    }
+
+    const auto& reflection = aManager->GetReflection();
+
+    auto processChunk = [&](size_t aIndex) {
+        auto& chunk = chunks[aIndex];
+
+        for (auto i = chunk.begin; i < chunk.end; ++i)
+        {
+            const auto& flatId = flats[i].first;
+            const auto& flatType = flats[i].second->type;
+            const auto& flatValue = flats[i].second->value.get();
+
+            if (aChangelog)
+            {
+                if (reflection->IsForeignKey(flatType))
+                {
+                    const auto foreignKey = reinterpret_cast<Red::TweakDBID*>(flatValue);
+                    chunk.foreignKeys.emplace_back(*foreignKey, flatId);
+                }
+                else if (reflection->IsForeignKeyArray(flatType))
+                {
+                    const auto foreignKeyList = reinterpret_cast<Red::DynArray<Red::TweakDBID>*>(flatValue);
+                    for (const auto& foreignKey : *foreignKeyList)
+                    {
+                        chunk.foreignKeys.emplace_back(foreignKey, flatId);
+                    }
+                }
+                else if (reflection->IsResRefToken(flatType))
+                {
+                    const auto resRef = reinterpret_cast<Red::ResourceAsyncReference<>*>(flatValue);
+                    chunk.resourcePaths.emplace_back(resRef->path, flatId);
+                }
+                else if (reflection->IsResRefTokenArray(flatType))
+                {
+                    const auto resRefList = reinterpret_cast<Red::DynArray<Red::ResourceAsyncReference<>>*>(flatValue);
+                    for (const auto& resRef : *resRefList)
+                    {
+                        chunk.resourcePaths.emplace_back(resRef.path, flatId);
+                    }
+                }
+            }
+
+            if (!aManager->SetFlat(aBatch, flatId, flatType, flatValue))
+            {
+                chunk.failures.push_back(flatId);
+            }
+        }
+    };
+
+    if (numberOfJobs > 1)
+    {
+        // Make sure the value pools are built before the workers start using them
+        aManager->GetDefault(flats.front().second->type);
+
+        // The helper jobs go through the commit job plumbing, so the changeset stays busy until all of them ran.
+        // The committing thread claims chunks as well and only waits for the ones that are already running,
+        // which can't stall when the commit itself runs on a job worker and the helpers never get scheduled.
+        // A helper that starts late finds no chunks left and doesn't touch the state of this call.
+        auto queue = Core::MakeShared<FlatChunkQueue>(numberOfJobs);
+
+        for (uint32_t i = 1; i < numberOfJobs; ++i)
+        {
+            StartAsyncCommitJob([queue, &processChunk]() {
+                size_t index;
+                while (queue->Claim(index))
+                {
+                    processChunk(index);
+                    queue->Release();
+                }
+            });
+        }
+
+        size_t index;
+        while (queue->Claim(index))
         {
-            LogError("Cannot update record {}.", aManager->GetName(recordId));
+            processChunk(index);
+            queue->Release();
         }
+
+        queue->WaitRunning();
+    }
+    else
+    {
+        processChunk(0);
     }
 
-    FinishCommitJob();
+    for (const auto& chunk : chunks)
+    {
+        if (aChangelog)
+        {
+            for (const auto& [foreignKey, flatId] : chunk.foreignKeys)
+            {
+                aChangelog->RegisterForeignKey(foreignKey, flatId);
+            }
+
+            for (const auto& [resourcePath, flatId] : chunk.resourcePaths)
+            {
+                aChangelog->RegisterResourcePath(resourcePath, flatId);
+            }
+        }
+
+        for (const auto& flatId : chunk.failures)
+        {
+            LogError("Can't assign flat {}.", aManager->GetName(flatId));
+        }
+    }
 }
 
 bool App::TweakChangeset::IsCommitFinished()
@@ -780,6 +1196,7 @@ void App::TweakChangeset::FinishCommitJob()
             m_orderedRecords.clear();
             m_pendingNames.clear();
             m_pendingMutations.clear();
+            m_commitGuard.reset();
 
             m_totalCommitChunks = 0;
             m_finishedCommitChunks = 0;
@@ -58,6 +58,57 @@ public:
         std::string appendix;
     };
 
+    enum class EOperation : uint8_t
+    {
+        SetFlat,
+        ReinheritFlat,
+        MakeRecord,
+        UpdateRecord,
+        AppendElement,
+        PrependElement,
+        RemoveElement,
+        RemoveAllElements,
+        AppendFrom,
+        PrependFrom,
+        RegisterName,
+    };
+
+    enum class EDependency : uint8_t
+    {
+        Flat,
+        Record,
+        BaseFlat, // Lookup in the database the changes are applied to
+        BaseRecord,
+    };
+
+    struct OperationEntry
+    {
+        EOperation operation;
+        Red::TweakDBID targetId;
+        Red::TweakDBID sourceId;
+        const Red::CBaseRTTIType* type;
+        Red::InstancePtr<> value;
+        std::string text;
+        bool unique;
+    };
+
+    struct DependencyEntry
+    {
+        EDependency kind;
+        Red::TweakDBID id;
+        const Red::CBaseRTTIType* type;
+    };
+
+    // A sequence of operations contributed by a single source,
+    // and the pending entries of other sources and the database entries that affected them.
+    struct Recording
+    {
+        Core::Vector<OperationEntry> operations;
+        Core::Vector<DependencyEntry> dependencies;
+    };
+
+    using RecordingPtr = Core::SharedPtr<Recording>;
+
     bool SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, const Red::InstancePtr<>& aValue);
     bool ReinheritFlat(Red::TweakDBID aFlatId, Red::TweakDBID aSourceId, const std::string& aAppendix);
 
@@ -81,14 +132,30 @@ public:
     const Red::CClass* GetRecordType(Red::TweakDBID aRecordId);
     bool HasRecord(Red::TweakDBID aRecordId);
 
+    // Lookups in the database itself, they're recorded so that a recording made against a different database
+    // isn't replayed.
+    const Red::CBaseRTTIType* GetBaseFlatType(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                              Red::TweakDBID aFlatId);
+    const Red::CClass* GetBaseRecordType(const Core::SharedPtr<Red::TweakDBManager>& aManager,
+                                         Red::TweakDBID aRecordId);
+
     bool IsEmpty();
 
+    void StartRecording();
+    RecordingPtr FinishRecording();
+    bool CanReplay(const Recording& aRecording, const Core::SharedPtr<Red::TweakDBManager>& aManager);
+    void Replay(const Recording& aRecording);
+
+    // When not reverting, the changes are applied on top of the previously committed ones.
     void Commit(const Core::SharedPtr<Red::TweakDBManager>& aManager,
-                const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+                const Core::SharedPtr<App::TweakChangelog>& aChangelog, bool aRevertChanges = true);
 
 private:
     using ElementChange = std::pair<int32_t, Core::SharedPtr<void>>;
 
+    void AssignFlats(const Core::SharedPtr<Red::TweakDBManager>& aManager, const Red::TweakDBManager::BatchPtr& aBatch,
+                     const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+
     bool IsCommitFinished();
     void StartCommitJob();
     void FinishCommitJob();
@@ -102,6 +169,9 @@ private:
         jobQueue.Dispatch([self = ToShared()]{ self->FinishCommitJob(); });
     }
 
+    void RecordOperation(OperationEntry&& aEntry);
+    void RecordDependency(EDependency aKind, Red::TweakDBID aId, const Red::CBaseRTTIType* aType);
+
     static int32_t FindElement(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue);
     static bool InArray(const Red::CRTTIArrayType* aArrayType, void* aArray, void* aValue);
     static bool IsSkip(const Red::CRTTIArrayType* aArrayType, void* aValue, int32_t aLevel,
@@ -115,7 +185,12 @@ private:
     Core::Map<Red::TweakDBID, ReinheritanceEntry> m_reinheritedProps;
     Core::Map<Red::TweakDBID, std::string> m_pendingNames;
 
+    RecordingPtr m_recording;
+    Core::Set<Red::TweakDBID> m_recordedIds;
+    Core::Set<Red::TweakDBID> m_recordedBaseIds;
+
     std::mutex m_commitMutex;
+    Red::TweakDBManager::CommitGuard m_commitGuard;
     int32_t m_totalCommitChunks{0};
     int32_t m_finishedCommitChunks{0};
 };
@@ -1,7 +1,6 @@
 #pragma once
 
 #include "App/Tweaks/Declarative/TweakReader.hpp"
-#include "Core/Logging/LoggingAgent.hpp"
 #include "Red/TweakDB/Source/Source.hpp"
 #include "Red/Value.hpp"
 
@@ -9,7 +8,6 @@ namespace App
 {
 class RedReader
     : public BaseTweakReader
-    , public Core::LoggingAgent
 {
 public:
     RedReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
@@ -0,0 +1,471 @@
+#include "TweakCache.hpp"
+
+namespace
+{
+constexpr uint32_t CacheMagic = 0x434C5854; // TXLC
+constexpr uint32_t CacheFormat = 2;
+
+constexpr uint32_t MaxStringLength = 16 * 1024 * 1024;
+constexpr uint32_t MaxArrayLength = 1024 * 1024;
+
+template<typename T>
+inline bool Read(std::istream& aIn, T& aValue)
+{
+    aIn.read(reinterpret_cast<char*>(&aValue), sizeof(T));
+    return aIn.good();
+}
+
+template<typename T>
+inline void Write(std::ostream& aOut, const T& aValue)
+{
+    aOut.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+}
+
+inline bool ReadString(std::istream& aIn, std::string& aValue)
+{
+    uint32_t length;
+    if (!Read(aIn, length) || length > MaxStringLength)
+        return false;
+
+    aValue.resize(length);
+    aIn.read(aValue.data(), length);
+    return aIn.good();
+}
+
+inline void WriteString(std::ostream& aOut, std::string_view aValue)
+{
+    Write(aOut, static_cast<uint32_t>(aValue.size()));
+    aOut.write(aValue.data(), static_cast<std::streamsize>(aValue.size()));
+}
+}
+
+App::TweakCache::TweakCache(std::filesystem::path aPath, std::string aTag,
+                            Core::SharedPtr<Red::TweakDBReflection> aReflection)
+    : m_path(std::move(aPath))
+    , m_tag(std::move(aTag))
+    , m_reflection(std::move(aReflection))
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+bool App::TweakCache::Load()
+{
+    std::unique_lock lockRW(m_mutex);
+
+    m_entries.clear();
+    m_retained.clear();
+
+    std::error_code error;
+    if (!std::filesystem::exists(m_path, error))
+        return false;
+
+    std::ifstream in(m_path, std::ios::binary);
+
+    uint32_t magic;
+    uint32_t format;
+    std::string tag;
+
+    if (!Read(in, magic) || magic != CacheMagic || !Read(in, format) || format != CacheFormat)
+    {
+        LogInfo("Tweak cache has unsupported format, rebuilding...");
+        return false;
+    }
+
+    if (!ReadString(in, tag) || tag != m_tag)
+    {
+        LogInfo("Tweak cache is outdated, rebuilding...");
+        return false;
+    }
+
+    uint32_t numberOfEntries;
+    if (!Read(in, numberOfEntries))
+        return false;
+
+    while (numberOfEntries > 0)
+    {
+        std::string key;
+        auto entry = Core::MakeShared<Entry>();
+
+        if (!ReadString(in, key) || !ReadEntry(in, *entry))
+        {
+            LogWarning("Tweak cache is corrupted, rebuilding...");
+            m_entries.clear();
+            return false;
+        }
+
+        m_entries.emplace(std::move(key), std::move(entry));
+
+        --numberOfEntries;
+    }
+
+    return true;
+}
+
+bool App::TweakCache::Save()
+{
+    std::unique_lock lockRW(m_mutex);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+
+    auto tempPath = m_path;
+    tempPath += L".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+        {
+            LogWarning("Can't write tweak cache \"{}\".", m_path.string());
+            return false;
+        }
+
+        Write(out, CacheMagic);
+        Write(out, CacheFormat);
+        WriteString(out, m_tag);
+
+        // Only entries used by the current import are kept,
+        // everything else is either stale or belongs to removed files.
+        Write(out, static_cast<uint32_t>(m_retained.size()));
+
+        for (const auto& key : m_retained)
+        {
+            WriteString(out, key);
+            WriteEntry(out, *m_entries[key]);
+        }
+
+        if (!out.good())
+        {
+            LogWarning("Can't write tweak cache \"{}\".", m_path.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, m_path, error);
+
+    if (error)
+    {
+        LogWarning("Can't write tweak cache \"{}\": {}.", m_path.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    return true;
+}
+
+App::TweakCache::EntryPtr App::TweakCache::Find(const std::string& aKey, uint64_t aSize, uint64_t aHash)
+{
+    std::shared_lock lockR(m_mutex);
+
+    const auto it = m_entries.find(aKey);
+
+    if (it == m_entries.end() || it->second->size != aSize || it->second->hash != aHash)
+        return nullptr;
+
+    return it->second;
+}
+
+void App::TweakCache::Store(const std::string& aKey, EntryPtr aEntry)
+{
+    std::unique_lock lockRW(m_mutex);
+
+    m_entries[aKey] = std::move(aEntry);
+    m_retained.insert(aKey);
+}
+
+void App::TweakCache::Retain(const std::string& aKey)
+{
+    std::unique_lock lockRW(m_mutex);
+
+    if (m_entries.contains(aKey))
+    {
+        m_retained.insert(aKey);
+    }
+}
+
+void App::TweakCache::RegisterHit()
+{
+    ++m_hits;
+}
+
+void App::TweakCache::RegisterMiss()
+{
+    ++m_misses;
+}
+
+void App::TweakCache::ResetStats()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+uint32_t App::TweakCache::GetHits() const
+{
+    return m_hits;
+}
+
+uint32_t App::TweakCache::GetMisses() const
+{
+    return m_misses;
+}
+
+bool App::TweakCache::ComputeKey(const std::filesystem::path& aPath, uint64_t& aSize, uint64_t& aHash)
+{
+    std::ifstream in(aPath, std::ios::binary | std::ios::ate);
+
+    if (!in.is_open())
+        return false;
+
+    const auto size = static_cast<size_t>(in.tellg());
+    std::string data(size, '\0');
+
+    in.seekg(0);
+    in.read(data.data(), static_cast<std::streamsize>(size));
+
+    if (!in.good())
+        return false;
+
+    aSize = size;
+    aHash = Red::FNV1a64(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+
+    return true;
+}
+
+bool App::TweakCache::ReadEntry(std::istream& aIn, Entry& aEntry)
+{
+    if (!Read(aIn, aEntry.size) || !Read(aIn, aEntry.hash))
+        return false;
+
+    aEntry.recording = Core::MakeShared<TweakChangeset::Recording>();
+
+    uint32_t numberOfOperations;
+    if (!Read(aIn, numberOfOperations))
+        return false;
+
+    aEntry.recording->operations.reserve(numberOfOperations);
+
+    while (numberOfOperations > 0)
+    {
+        auto& operation = aEntry.recording->operations.emplace_back();
+        bool hasValue;
+
+        if (!Read(aIn, operation.operation) || !Read(aIn, operation.targetId) || !Read(aIn, operation.sourceId))
+            return false;
+
+        if (!ReadType(aIn, operation.type) || !ReadString(aIn, operation.text) || !Read(aIn, operation.unique))
+            return false;
+
+        if (!Read(aIn, hasValue))
+            return false;
+
+        if (hasValue)
+        {
+            if (!m_reflection->IsFlatType(operation.type))
+                return false;
+
+            operation.value = m_reflection->Construct(operation.type);
+
+            if (!ReadValue(aIn, operation.type, operation.value.get()))
+                return false;
+        }
+
+        --numberOfOperations;
+    }
+
+    uint32_t numberOfDependencies;
+    if (!Read(aIn, numberOfDependencies))
+        return false;
+
+    aEntry.recording->dependencies.reserve(numberOfDependencies);
+
+    while (numberOfDependencies > 0)
+    {
+        auto& dependency = aEntry.recording->dependencies.emplace_back();
+
+        if (!Read(aIn, dependency.kind) || !Read(aIn, dependency.id) || !ReadType(aIn, dependency.type))
+            return false;
+
+        --numberOfDependencies;
+    }
+
+    uint32_t numberOfDiagnostics;
+    if (!Read(aIn, numberOfDiagnostics))
+        return false;
+
+    while (numberOfDiagnostics > 0)
+    {
+        auto& diagnostic = aEntry.diagnostics.emplace_back();
+
+        if (!Read(aIn, diagnostic.level) || !ReadString(aIn, diagnostic.message))
+            return false;
+
+        --numberOfDiagnostics;
+    }
+
+    return true;
+}
+
+void App::TweakCache::WriteEntry(std::ostream& aOut, const Entry& aEntry)
+{
+    Write(aOut, aEntry.size);
+    Write(aOut, aEntry.hash);
+
+    Write(aOut, static_cast<uint32_t>(aEntry.recording->operations.size()));
+
+    for (const auto& operation : aEntry.recording->operations)
+    {
+        const bool hasValue = operation.value != nullptr;
+
+        Write(aOut, operation.operation);
+        Write(aOut, operation.targetId);
+        Write(aOut, operation.sourceId);
+        WriteType(aOut, operation.type);
+        WriteString(aOut, operation.text);
+        Write(aOut, operation.unique);
+        Write(aOut, hasValue);
+
+        if (hasValue)
+        {
+            WriteValue(aOut, operation.type, operation.value.get());
+        }
+    }
+
+    Write(aOut, static_cast<uint32_t>(aEntry.recording->dependencies.size()));
+
+    for (const auto& dependency : aEntry.recording->dependencies)
+    {
+        Write(aOut, dependency.kind);
+        Write(aOut, dependency.id);
+        WriteType(aOut, dependency.type);
+    }
+
+    Write(aOut, static_cast<uint32_t>(aEntry.diagnostics.size()));
+
+    for (const auto& diagnostic : aEntry.diagnostics)
+    {
+        Write(aOut, diagnostic.level);
+        WriteString(aOut, diagnostic.message);
+    }
+}
+
+bool App::TweakCache::ReadType(std::istream& aIn, const Red::CBaseRTTIType*& aType)
+{
+    Red::CName typeName;
+    if (!Read(aIn, typeName.hash))
+        return false;
+
+    if (typeName.IsNone())
+    {
+        aType = nullptr;
+        return true;
+    }
+
+    aType = Red::CRTTISystem::Get()->GetType(typeName);
+
+    return aType != nullptr;
+}
+
+void App::TweakCache::WriteType(std::ostream& aOut, const Red::CBaseRTTIType* aType)
+{
+    const auto typeName = aType ? aType->GetName() : Red::CName();
+    Write(aOut, typeName.hash);
+}
+
+bool App::TweakCache::ReadValue(std::istream& aIn, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
+{
+    if (aType->GetType() == Red::ERTTIType::Array)
+    {
+        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
+        auto* elementType = arrayType->innerType;
+
+        uint32_t length;
+        if (!Read(aIn, length) || length > MaxArrayLength)
+            return false;
+
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            arrayType->InsertAt(aInstance, static_cast<int32_t>(i));
+
+            if (!ReadValue(aIn, elementType, arrayType->GetElement(aInstance, i)))
+                return false;
+        }
+
+        return true;
+    }
+
+    switch (aType->GetName())
+    {
+    case Red::ERTDBFlatType::String:
+    {
+        std::string str;
+        if (!ReadString(aIn, str))
+            return false;
+
+        *reinterpret_cast<Red::CString*>(aInstance) = str.c_str();
+        return true;
+    }
+    case Red::ERTDBFlatType::CName:
+    {
+        Red::CName name;
+        std::string str;
+        if (!Read(aIn, name.hash) || !ReadString(aIn, str))
+            return false;
+
+        // Names must be added to the pool to be resolvable later
+        if (!str.empty() && Red::CName(str.c_str()) == name)
+        {
+            name = Red::CNamePool::Add(str.c_str());
+        }
+
+        *reinterpret_cast<Red::CName*>(aInstance) = name;
+        return true;
+    }
+    default:
+    {
+        aIn.read(reinterpret_cast<char*>(aInstance), aType->GetSize());
+        return aIn.good();
+    }
+    }
+}
+
+void App::TweakCache::WriteValue(std::ostream& aOut, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
+{
+    if (aType->GetType() == Red::ERTTIType::Array)
+    {
+        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
+        auto* elementType = arrayType->innerType;
+        const auto length = arrayType->GetLength(aInstance);
+
+        Write(aOut, static_cast<uint32_t>(length));
+
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            WriteValue(aOut, elementType, arrayType->GetElement(aInstance, i));
+        }
+
+        return;
+    }
+
+    switch (aType->GetName())
+    {
+    case Red::ERTDBFlatType::String:
+    {
+        const auto* str = reinterpret_cast<Red::CString*>(aInstance);
+        WriteString(aOut, {str->c_str(), str->Length()});
+        break;
+    }
+    case Red::ERTDBFlatType::CName:
+    {
+        const auto* name = reinterpret_cast<Red::CName*>(aInstance);
+        Write(aOut, name->hash);
+        WriteString(aOut, name->ToString());
+        break;
+    }
+    default:
+    {
+        aOut.write(reinterpret_cast<const char*>(aInstance), aType->GetSize());
+        break;
+    }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
+#include "Red/TweakDB/Reflection.hpp"
+
+namespace App
+{
+class TweakCache : Core::LoggingAgent
+{
+public:
+    enum class EDiagnostic : uint8_t
+    {
+        Warning,
+        Error,
+    };
+
+    struct Diagnostic
+    {
+        EDiagnostic level;
+        std::string message;
+    };
+
+    struct Entry
+    {
+        uint64_t size;
+        uint64_t hash;
+        TweakChangeset::RecordingPtr recording;
+        Core::Vector<Diagnostic> diagnostics;
+    };
+
+    using EntryPtr = Core::SharedPtr<Entry>;
+
+    TweakCache(std::filesystem::path aPath, std::string aTag, Core::SharedPtr<Red::TweakDBReflection> aReflection);
+
+    bool Load();
+    bool Save();
+
+    EntryPtr Find(const std::string& aKey, uint64_t aSize, uint64_t aHash);
+    void Store(const std::string& aKey, EntryPtr aEntry);
+    void Retain(const std::string& aKey);
+
+    void RegisterHit();
+    void RegisterMiss();
+    void ResetStats();
+    [[nodiscard]] uint32_t GetHits() const;
+    [[nodiscard]] uint32_t GetMisses() const;
+
+    static bool ComputeKey(const std::filesystem::path& aPath, uint64_t& aSize, uint64_t& aHash);
+
+private:
+    bool ReadEntry(std::istream& aIn, Entry& aEntry);
+    void WriteEntry(std::ostream& aOut, const Entry& aEntry);
+
+    bool ReadType(std::istream& aIn, const Red::CBaseRTTIType*& aType);
+    void WriteType(std::ostream& aOut, const Red::CBaseRTTIType* aType);
+
+    bool ReadValue(std::istream& aIn, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
+    void WriteValue(std::ostream& aOut, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
+
+    std::filesystem::path m_path;
+    std::string m_tag;
+    Core::SharedPtr<Red::TweakDBReflection> m_reflection;
+    Core::Map<std::string, EntryPtr> m_entries;
+    Core::Set<std::string> m_retained;
+    std::shared_mutex m_mutex;
+    std::atomic_uint32_t m_hits;
+    std::atomic_uint32_t m_misses;
+};
+}
@@ -2,95 +2,212 @@
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
 #include "App/Tweaks/Declarative/Yaml/YamlReader.hpp"
 #include "App/Tweaks/Declarative/Red/RedReader.hpp"
+#include "Core/Tracing/Tracer.hpp"
+
+namespace
+{
+// The recordings hold a copy of every change, so tracking is given up for very large mod lists
+constexpr size_t MaxTrackedOperations = 2000000;
+}
 
 App::TweakImporter::TweakImporter(Core::SharedPtr<Red::TweakDBManager> aManager,
                                   Core::SharedPtr<App::TweakContext> aContext)
     : m_manager(std::move(aManager))
     , m_context(std::move(aContext))
+    , m_trackedOperations(0)
+    , m_workerCount(0)
+    , m_tracking(false)
+{
+}
+
+void App::TweakImporter::SetWorkerCount(uint32_t aWorkerCount)
+{
+    m_workerCount = aWorkerCount;
+}
+
+void App::TweakImporter::SetCache(Core::SharedPtr<App::TweakCache> aCache)
+{
+    m_cache = std::move(aCache);
+}
+
+void App::TweakImporter::SetChangeTracking(bool aEnabled)
 {
+    m_tracking = aEnabled;
+
+    if (!m_tracking)
+    {
+        m_sources.clear();
+    }
 }
 
 void App::TweakImporter::ImportTweaks(const Core::Vector<std::filesystem::path>& aImportPaths,
                                       const Core::SharedPtr<App::TweakChangelog>& aChangelog,
                                       bool aDryRun)
 {
+    Core::TraceSpan span("Importing tweaks", "Import");
+
     try
     {
         LogInfo("Scanning for tweaks...");
 
         auto changeset = Core::MakeShared<TweakChangeset>();
+        auto entries = CollectEntries(aImportPaths);
 
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> firstPriorityPaths;
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> secondPriorityPaths;
-        Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> lastPriorityPaths;
-        std::error_code error;
+        if (m_cache)
+        {
+            m_cache->ResetStats();
+        }
+
+        auto workerCount = m_workerCount ? m_workerCount : std::thread::hardware_concurrency();
+        workerCount = std::min(workerCount, static_cast<uint32_t>(entries.size()));
 
-        for (const auto& importPath : aImportPaths)
+        // With multiple workers, all files are loaded and parsed upfront,
+        // but the changes are still read in the original priority order.
+        if (workerCount > 1)
         {
-            if (std::filesystem::is_directory(importPath, error))
+            LoadAll(entries, workerCount);
+        }
+
+        for (auto& entry : entries)
+        {
+            Read(changeset, entry);
+        }
+
+        if (m_cache)
+        {
+            LogInfo("Tweak cache: {} hits, {} misses.", m_cache->GetHits(), m_cache->GetMisses());
+            m_cache->Save();
+        }
+
+        if (!aDryRun)
+        {
+            if (m_tracking)
             {
-                const auto dirIt = std::filesystem::recursive_directory_iterator(
-                    importPath, std::filesystem::directory_options::follow_directory_symlink);
-                for (const auto& entry : dirIt)
+                m_sources.clear();
+                m_sources.reserve(entries.size());
+                m_trackedOperations = 0;
+
+                for (auto& entry : entries)
                 {
-                    if (entry.is_regular_file())
+                    // Sources that can't be compared later invalidate the whole snapshot
+                    if (!entry.hashed)
                     {
-                        if (IsFirstPriority(entry.path()))
-                        {
-                            firstPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
-                        else if (IsLastPriority(entry.path()))
-                        {
-                            lastPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
-                        else
-                        {
-                            secondPriorityPaths.emplace_back(entry.path(), importPath);
-                        }
+                        m_sources.clear();
+                        m_trackedOperations = 0;
+                        break;
                     }
+
+                    m_trackedOperations += CountOperations(entry.recording);
+                    m_sources.push_back({entry.key, entry.size, entry.hash, std::move(entry.recording)});
                 }
-                continue;
+
+                DropExcessiveTracking();
             }
 
-            if (std::filesystem::is_regular_file(importPath, error))
+            Apply(changeset, aChangelog);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        m_sources.clear();
+        LogError(ex.what());
+    }
+    catch (...)
+    {
+        m_sources.clear();
+        LogError("An unknown error occurred while trying to import tweaks.");
+    }
+}
+
+bool App::TweakImporter::ImportChanges(const Core::Vector<std::filesystem::path>& aImportPaths,
+                                       const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    if (!m_tracking || m_sources.empty() || !aChangelog)
+        return false;
+
+    Core::TraceSpan span("Importing changed tweaks", "Import");
+
+    try
+    {
+        LogInfo("Scanning for changed tweaks...");
+
+        auto entries = CollectEntries(aImportPaths);
+
+        if (entries.size() != m_sources.size())
+        {
+            LogInfo("Tweaks were added or removed, reloading all tweaks...");
+            return false;
+        }
+
+        Core::Set<size_t> changed;
+
+        for (size_t index = 0; index < entries.size(); ++index)
+        {
+            auto& entry = entries[index];
+            const auto& source = m_sources[index];
+
+            entry.hashed = TweakCache::ComputeKey(entry.path, entry.size, entry.hash);
+
+            if (!entry.hashed || entry.key != source.key)
             {
-                if (IsFirstPriority(importPath))
-                {
-                    firstPriorityPaths.emplace_back(importPath, importPath.parent_path());
-                }
-                else if (IsLastPriority(importPath))
-                {
-                    lastPriorityPaths.emplace_back(importPath, importPath.parent_path());
-                }
-                else
-                {
-                    secondPriorityPaths.emplace_back(importPath, importPath.parent_path());
-                }
-                continue;
+                LogInfo("Tweaks were renamed or reordered, reloading all tweaks...");
+                return false;
             }
 
-            LogWarning("Can't import \"{}\".", importPath.string());
+            if (entry.size != source.size || entry.hash != source.hash)
+            {
+                changed.insert(index);
+            }
         }
 
-        for (const auto& [importPath, importDir] : firstPriorityPaths)
+        if (changed.empty())
         {
-            Read(changeset, importPath, importDir);
+            LogInfo("No changes detected.");
+            return true;
         }
 
-        for (const auto& [importPath, importDir] : secondPriorityPaths)
+        // The changed files are read in the context of all other files,
+        // so that any lookups of pending changes see the same state as a full import.
+        auto changeset = Core::MakeShared<TweakChangeset>();
+
+        for (size_t index = 0; index < entries.size(); ++index)
         {
-            Read(changeset, importPath, importDir);
+            if (changed.contains(index))
+            {
+                Read(changeset, entries[index]);
+            }
+            else if (m_sources[index].recording)
+            {
+                changeset->Replay(*m_sources[index].recording);
+            }
         }
 
-        for (const auto& [importPath, importDir] : lastPriorityPaths)
+        if (!IsSeparable(entries, changed))
         {
-            Read(changeset, importPath, importDir);
+            LogInfo("Changed tweaks depend on other tweaks, reloading all tweaks...");
+            return false;
         }
 
-        if (!aDryRun)
+        if (!ApplyChanges(entries, changed, aChangelog))
         {
-            Apply(changeset, aChangelog);
+            LogInfo("Removed changes can't be reverted, reloading all tweaks...");
+            return false;
+        }
+
+        for (const auto& index : changed)
+        {
+            auto& source = m_sources[index];
+            m_trackedOperations -= CountOperations(source.recording);
+            m_trackedOperations += CountOperations(entries[index].recording);
+
+            source.size = entries[index].size;
+            source.hash = entries[index].hash;
+            source.recording = std::move(entries[index].recording);
         }
+
+        DropExcessiveTracking();
+
+        return true;
     }
     catch (const std::exception& ex)
     {
@@ -98,58 +215,274 @@ void App::TweakImporter::ImportTweaks(const Core::Vector<std::filesystem::path>&
     }
     catch (...)
     {
-        LogError("An unknown error occurred while trying to import tweaks.");
+        LogError("An unknown error occurred while trying to import changed tweaks.");
     }
+
+    return false;
 }
 
-bool App::TweakImporter::Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
-                              const std::filesystem::path& aPath,
-                              const std::filesystem::path& aDir)
+Core::Vector<App::TweakImporter::ImportEntry> App::TweakImporter::CollectEntries(
+    const Core::Vector<std::filesystem::path>& aImportPaths)
 {
-    Core::SharedPtr<ITweakReader> reader;
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> firstPriorityPaths;
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> secondPriorityPaths;
+    Core::Vector<std::pair<std::filesystem::path, std::filesystem::path>> lastPriorityPaths;
+    std::error_code error;
 
+    for (const auto& importPath : aImportPaths)
     {
-        const auto ext = aPath.extension();
+        if (std::filesystem::is_directory(importPath, error))
+        {
+            const auto dirIt = std::filesystem::recursive_directory_iterator(
+                importPath, std::filesystem::directory_options::follow_directory_symlink);
+            for (const auto& entry : dirIt)
+            {
+                if (entry.is_regular_file())
+                {
+                    if (IsFirstPriority(entry.path()))
+                    {
+                        firstPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                    else if (IsLastPriority(entry.path()))
+                    {
+                        lastPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                    else
+                    {
+                        secondPriorityPaths.emplace_back(entry.path(), importPath);
+                    }
+                }
+            }
+            continue;
+        }
 
-        if (ext == L".yaml" || ext == L".yml")
+        if (std::filesystem::is_regular_file(importPath, error))
         {
-            reader = Core::MakeShared<YamlReader>(m_manager, m_context);
+            if (IsFirstPriority(importPath))
+            {
+                firstPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            else if (IsLastPriority(importPath))
+            {
+                lastPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            else
+            {
+                secondPriorityPaths.emplace_back(importPath, importPath.parent_path());
+            }
+            continue;
         }
-        else if (ext == L".tweak")
+
+        LogWarning("Can't import \"{}\".", importPath.string());
+    }
+
+    Core::Vector<ImportEntry> entries;
+    entries.reserve(firstPriorityPaths.size() + secondPriorityPaths.size() + lastPriorityPaths.size());
+
+    for (const auto& priorityPaths : {&firstPriorityPaths, &secondPriorityPaths, &lastPriorityPaths})
+    {
+        for (const auto& [importPath, importDir] : *priorityPaths)
         {
-            reader = Core::MakeShared<RedReader>(m_manager, m_context);
+            auto reader = MakeReader(importPath);
+
+            if (!reader)
+                continue;
+
+            auto& entry = entries.emplace_back();
+            entry.path = importPath;
+            entry.dir = importDir;
+            entry.reader = std::move(reader);
+            entry.key = importPath.string();
         }
     }
 
-    if (!reader)
+    return entries;
+}
+
+Core::SharedPtr<App::ITweakReader> App::TweakImporter::MakeReader(const std::filesystem::path& aPath)
+{
+    const auto ext = aPath.extension();
+
+    if (ext == L".yaml" || ext == L".yml")
     {
-        return false;
+        return Core::MakeShared<YamlReader>(m_manager, m_context);
+    }
+
+    if (ext == L".tweak")
+    {
+        return Core::MakeShared<RedReader>(m_manager, m_context);
     }
 
+    return {};
+}
+
+void App::TweakImporter::Prepare(ImportEntry& aEntry)
+{
+    if ((m_cache || m_tracking) && !aEntry.hashed)
+    {
+        aEntry.hashed = TweakCache::ComputeKey(aEntry.path, aEntry.size, aEntry.hash);
+    }
+
+    if (m_cache)
+    {
+        if (aEntry.hashed)
+        {
+            aEntry.cached = m_cache->Find(aEntry.key, aEntry.size, aEntry.hash);
+
+            if (aEntry.cached)
+                return;
+        }
+    }
+
+    Load(aEntry);
+}
+
+void App::TweakImporter::Load(ImportEntry& aEntry)
+{
+    Core::TraceSpan span("Loading", "Import", aEntry.key);
+
+    try
+    {
+        aEntry.loaded = aEntry.reader->Load(aEntry.path);
+    }
+    catch (const std::exception& ex)
+    {
+        aEntry.error = ex.what();
+    }
+    catch (...)
+    {
+        aEntry.error = "An unknown error occurred.";
+    }
+
+    aEntry.processed = true;
+}
+
+void App::TweakImporter::LoadAll(Core::Vector<ImportEntry>& aEntries, uint32_t aWorkerCount)
+{
+    std::atomic_size_t nextIndex = 0;
+
+    auto worker = [&aEntries, &nextIndex, this]() {
+        for (auto index = nextIndex++; index < aEntries.size(); index = nextIndex++)
+        {
+            Prepare(aEntries[index]);
+        }
+    };
+
+    Core::Vector<std::thread> threads;
+    threads.reserve(aWorkerCount - 1);
+
+    for (auto i = 1u; i < aWorkerCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool App::TweakImporter::Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset, ImportEntry& aEntry)
+{
     try
     {
         std::error_code error;
-        auto path = std::filesystem::relative(aPath, aDir, error);
+        auto path = std::filesystem::relative(aEntry.path, aEntry.dir, error);
         if (path.empty())
         {
-            path = std::filesystem::absolute(aPath, error);
-            path = std::filesystem::relative(path, aDir, error);
+            path = std::filesystem::absolute(aEntry.path, error);
+            path = std::filesystem::relative(path, aEntry.dir, error);
         }
 
         LogInfo("Reading \"{}\"...", path.string());
 
-        if (reader->Load(aPath))
+        Core::TraceSpan span(path.string(), "Import");
+
+        if (!aEntry.processed && !aEntry.cached)
         {
-            reader->Read(*aChangeset);
+            Prepare(aEntry);
+        }
+
+        if (aEntry.cached)
+        {
+            // The cached changes can only be reused if the pending changes of other files
+            // that affected them are still the same.
+            if (aChangeset->CanReplay(*aEntry.cached->recording, m_manager))
+            {
+                Core::TraceSpan replaySpan("Replaying", "Import");
+
+                aChangeset->Replay(*aEntry.cached->recording);
+                aEntry.recording = aEntry.cached->recording;
+
+                for (const auto& diagnostic : aEntry.cached->diagnostics)
+                {
+                    if (diagnostic.level == TweakCache::EDiagnostic::Error)
+                        LogError(diagnostic.message.c_str());
+                    else
+                        LogWarning(diagnostic.message.c_str());
+                }
+
+                m_cache->Retain(aEntry.key);
+                m_cache->RegisterHit();
+                return true;
+            }
+
+            aEntry.cached.reset();
+            Load(aEntry);
+        }
+
+        if (m_cache)
+        {
+            m_cache->RegisterMiss();
+        }
+
+        if (!aEntry.error.empty())
+        {
+            LogError(aEntry.error.c_str());
+            return false;
+        }
+
+        if (aEntry.loaded)
+        {
+            Core::TraceSpan readSpan("Reading", "Import");
+
+            if (m_cache || m_tracking)
+            {
+                auto cacheEntry = Core::MakeShared<TweakCache::Entry>();
+                cacheEntry->size = aEntry.size;
+                cacheEntry->hash = aEntry.hash;
+
+                aEntry.reader->CollectDiagnostics(&cacheEntry->diagnostics);
+                aChangeset->StartRecording();
+                aEntry.reader->Read(*aChangeset);
+                aEntry.recording = aChangeset->FinishRecording();
+                aEntry.reader->CollectDiagnostics(nullptr);
+
+                if (m_cache && aEntry.hashed)
+                {
+                    cacheEntry->recording = aEntry.recording;
+                    m_cache->Store(aEntry.key, std::move(cacheEntry));
+                }
+            }
+            else
+            {
+                aEntry.reader->Read(*aChangeset);
+            }
+
+            aEntry.reader->Unload();
         }
     }
     catch (const std::exception& ex)
     {
+        aEntry.recording = aChangeset->FinishRecording();
         LogError(ex.what());
         return false;
     }
     catch (...)
     {
+        aEntry.recording = aChangeset->FinishRecording();
         LogError("An unknown error occurred.");
         return false;
     }
@@ -175,6 +508,226 @@ bool App::TweakImporter::Apply(const Core::SharedPtr<App::TweakChangeset>& aChan
     return true;
 }
 
+bool App::TweakImporter::IsSeparable(const Core::Vector<ImportEntry>& aEntries, const Core::Set<size_t>& aChanged)
+{
+    Core::Map<Red::TweakDBID, size_t> changedFlats;
+    Core::Set<Red::TweakDBID> changedRecords;
+
+    // Only plain assignments of existing records and flats can be applied separately,
+    // anything that involves creation, cloning, inheritance or array merging depends on the import order.
+    for (const auto& index : aChanged)
+    {
+        for (const auto& recording : {m_sources[index].recording, aEntries[index].recording})
+        {
+            if (!recording)
+                continue;
+
+            for (const auto& operation : recording->operations)
+            {
+                switch (operation.operation)
+                {
+                case TweakChangeset::EOperation::SetFlat:
+                {
+                    // The outcome of assignments from multiple changed files depends on the order
+                    const auto [it, inserted] = changedFlats.emplace(operation.targetId, index);
+
+                    if (!inserted && it->second != index)
+                        return false;
+
+                    break;
+                }
+                case TweakChangeset::EOperation::MakeRecord:
+                {
+                    if (operation.sourceId.IsValid())
+                        return false;
+
+                    if (m_manager->GetRecordType(operation.targetId) != operation.type)
+                        return false;
+
+                    changedRecords.insert(operation.targetId);
+                    break;
+                }
+                case TweakChangeset::EOperation::UpdateRecord:
+                {
+                    if (!m_manager->IsRecordExists(operation.targetId))
+                        return false;
+
+                    changedRecords.insert(operation.targetId);
+                    break;
+                }
+                case TweakChangeset::EOperation::RegisterName:
+                {
+                    break;
+                }
+                default:
+                {
+                    return false;
+                }
+                }
+            }
+        }
+    }
+
+    for (size_t index = 0; index < m_sources.size(); ++index)
+    {
+        if (aChanged.contains(index) || !m_sources[index].recording)
+            continue;
+
+        const auto& recording = m_sources[index].recording;
+
+        for (const auto& operation : recording->operations)
+        {
+            switch (operation.operation)
+            {
+            case TweakChangeset::EOperation::MakeRecord:
+            case TweakChangeset::EOperation::UpdateRecord:
+            case TweakChangeset::EOperation::RegisterName:
+            {
+                break;
+            }
+            default:
+            {
+                if (changedFlats.contains(operation.targetId))
+                    return false;
+
+                break;
+            }
+            }
+
+            if (operation.sourceId.IsValid())
+            {
+                if (changedFlats.contains(operation.sourceId) || changedRecords.contains(operation.sourceId))
+                    return false;
+            }
+        }
+
+        for (const auto& dependency : recording->dependencies)
+        {
+            if (changedFlats.contains(dependency.id) || changedRecords.contains(dependency.id))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool App::TweakImporter::ApplyChanges(const Core::Vector<ImportEntry>& aEntries, const Core::Set<size_t>& aChanged,
+                                      const Core::SharedPtr<App::TweakChangelog>& aChangelog)
+{
+    Core::Map<Red::TweakDBID, const TweakChangeset::OperationEntry*> previousFlats;
+    Core::Map<Red::TweakDBID, const TweakChangeset::OperationEntry*> currentFlats;
+    Core::Set<Red::TweakDBID> affectedRecords;
+
+    auto changeset = Core::MakeShared<TweakChangeset>();
+
+    for (const auto& index : aChanged)
+    {
+        if (const auto& recording = m_sources[index].recording)
+        {
+            for (const auto& operation : recording->operations)
+            {
+                if (operation.operation == TweakChangeset::EOperation::SetFlat)
+                {
+                    previousFlats[operation.targetId] = &operation;
+                }
+                else if (operation.operation != TweakChangeset::EOperation::RegisterName)
+                {
+                    affectedRecords.insert(operation.targetId);
+                }
+            }
+        }
+
+        if (const auto& recording = aEntries[index].recording)
+        {
+            for (const auto& operation : recording->operations)
+            {
+                if (operation.operation == TweakChangeset::EOperation::SetFlat)
+                {
+                    currentFlats[operation.targetId] = &operation;
+                }
+                else if (operation.operation == TweakChangeset::EOperation::RegisterName)
+                {
+                    changeset->RegisterName(operation.targetId, operation.text);
+                }
+                else
+                {
+                    affectedRecords.insert(operation.targetId);
+                }
+            }
+        }
+    }
+
+    Core::Vector<Red::TweakDBID> removedFlats;
+
+    for (const auto& [flatId, previous] : previousFlats)
+    {
+        if (!currentFlats.contains(flatId))
+        {
+            // A flat that can't be restored would keep the removed value, only a full import can fix it,
+            // so all removals are checked before anything is reverted
+            if (!aChangelog->CanRevertAssignment(m_manager, flatId))
+                return false;
+
+            removedFlats.push_back(flatId);
+        }
+    }
+
+    uint32_t numberOfChanges = 0;
+
+    for (const auto& flatId : removedFlats)
+    {
+        // Only a failed allocation can get here, the full import reverts the flats restored so far
+        if (!aChangelog->RevertAssignment(m_manager, flatId))
+            return false;
+
+        aChangelog->ForgetReferences(flatId);
+        ++numberOfChanges;
+    }
+
+    for (const auto& [flatId, current] : currentFlats)
+    {
+        const auto previous = previousFlats.find(flatId);
+
+        if (previous != previousFlats.end() && previous->second->type == current->type &&
+            current->type->IsEqual(previous->second->value.get(), current->value.get()))
+            continue;
+
+        aChangelog->ForgetReferences(flatId);
+        changeset->SetFlat(flatId, current->type, current->value);
+        ++numberOfChanges;
+    }
+
+    for (const auto& recordId : affectedRecords)
+    {
+        changeset->UpdateRecord(recordId);
+    }
+
+    LogInfo("Importing {} changed flats...", numberOfChanges);
+
+    changeset->Commit(m_manager, aChangelog, false);
+
+    LogInfo("Import completed.");
+
+    return true;
+}
+
+size_t App::TweakImporter::CountOperations(const TweakChangeset::RecordingPtr& aRecording)
+{
+    return aRecording ? aRecording->operations.size() + aRecording->dependencies.size() : 0;
+}
+
+void App::TweakImporter::DropExcessiveTracking()
+{
+    if (m_trackedOperations > MaxTrackedOperations)
+    {
+        LogInfo("Too many changes to track, reloads will import all tweaks.");
+
+        m_sources.clear();
+        m_sources.shrink_to_fit();
+        m_trackedOperations = 0;
+    }
+}
+
 bool App::TweakImporter::IsFirstPriority(const std::filesystem::path& aPath)
 {
     const std::string s_firstPriorityMarkers = "_#$!";
@@ -2,6 +2,7 @@
 
 #include "App/Tweaks/Batch/TweakChangelog.hpp"
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "App/Tweaks/Declarative/TweakCache.hpp"
 #include "App/Tweaks/Declarative/TweakReader.hpp"
 #include "App/Tweaks/TweakContext.hpp"
 #include "Core/Logging/LoggingAgent.hpp"
@@ -18,17 +19,71 @@ public:
                       const Core::SharedPtr<App::TweakChangelog>& aChangelog = nullptr,
                       bool aDryRun = false);
 
+    // Applies only the changes of modified files on top of the previous import.
+    // Returns false if the files changed in a way that requires a full import.
+    bool ImportChanges(const Core::Vector<std::filesystem::path>& aImportPaths,
+                       const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+
+    // Number of threads used to load and parse tweak files.
+    // Zero picks the number of hardware threads, one disables parallel loading.
+    void SetWorkerCount(uint32_t aWorkerCount);
+
+    // Cache of the changes produced by each file.
+    // Must only be used when the state of the database is known to be the same between sessions.
+    void SetCache(Core::SharedPtr<App::TweakCache> aCache);
+
+    // Keeps the changes produced by each file of the last import to enable ImportChanges().
+    void SetChangeTracking(bool aEnabled);
+
 private:
-    bool Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
-              const std::filesystem::path& aPath,
-              const std::filesystem::path& aDir);
+    struct ImportEntry
+    {
+        std::filesystem::path path;
+        std::filesystem::path dir;
+        Core::SharedPtr<ITweakReader> reader;
+        TweakCache::EntryPtr cached;
+        TweakChangeset::RecordingPtr recording;
+        std::string key;
+        uint64_t size{0};
+        uint64_t hash{0};
+        std::string error;
+        bool hashed{false};
+        bool processed{false};
+        bool loaded{false};
+    };
+
+    struct SourceEntry
+    {
+        std::string key;
+        uint64_t size;
+        uint64_t hash;
+        TweakChangeset::RecordingPtr recording;
+    };
+
+    Core::Vector<ImportEntry> CollectEntries(const Core::Vector<std::filesystem::path>& aImportPaths);
+    Core::SharedPtr<ITweakReader> MakeReader(const std::filesystem::path& aPath);
+    void Prepare(ImportEntry& aEntry);
+    void Load(ImportEntry& aEntry);
+    void LoadAll(Core::Vector<ImportEntry>& aEntries, uint32_t aWorkerCount);
+    bool Read(const Core::SharedPtr<App::TweakChangeset>& aChangeset, ImportEntry& aEntry);
     bool Apply(const Core::SharedPtr<App::TweakChangeset>& aChangeset,
                const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+    bool IsSeparable(const Core::Vector<ImportEntry>& aEntries, const Core::Set<size_t>& aChanged);
+    bool ApplyChanges(const Core::Vector<ImportEntry>& aEntries, const Core::Set<size_t>& aChanged,
+                      const Core::SharedPtr<App::TweakChangelog>& aChangelog);
+
+    void DropExcessiveTracking();
 
+    static size_t CountOperations(const TweakChangeset::RecordingPtr& aRecording);
     static bool IsFirstPriority(const std::filesystem::path& aPath);
     static bool IsLastPriority(const std::filesystem::path& aPath);
 
     Core::SharedPtr<Red::TweakDBManager> m_manager;
     Core::SharedPtr<App::TweakContext> m_context;
+    Core::SharedPtr<App::TweakCache> m_cache;
+    Core::Vector<SourceEntry> m_sources;
+    size_t m_trackedOperations;
+    uint32_t m_workerCount;
+    bool m_tracking;
 };
 }
@@ -22,9 +22,35 @@ App::BaseTweakReader::BaseTweakReader(Core::SharedPtr<Red::TweakDBManager> aMana
     : m_manager(std::move(aManager))
     , m_reflection(m_manager->GetReflection())
     , m_context(std::move(aContext))
+    , m_diagnostics(nullptr)
 {
 }
 
+void App::BaseTweakReader::CollectDiagnostics(Core::Vector<TweakCache::Diagnostic>* aDiagnostics)
+{
+    m_diagnostics = aDiagnostics;
+}
+
+void App::BaseTweakReader::LogWarning(const char* aMessage)
+{
+    if (m_diagnostics)
+    {
+        m_diagnostics->push_back({TweakCache::EDiagnostic::Warning, aMessage});
+    }
+
+    Core::LoggingAgent::LogWarning(aMessage);
+}
+
+void App::BaseTweakReader::LogError(const char* aMessage)
+{
+    if (m_diagnostics)
+    {
+        m_diagnostics->push_back({TweakCache::EDiagnostic::Error, aMessage});
+    }
+
+    Core::LoggingAgent::LogError(aMessage);
+}
+
 bool App::BaseTweakReader::IsOriginalBaseRecord(Red::TweakDBID aRecordId)
 {
     return m_reflection->IsOriginalBaseRecord(aRecordId);
@@ -118,10 +144,10 @@ std::string App::BaseTweakReader::ComposePath(const std::string& aParentPath, in
 const Red::CBaseRTTIType* App::BaseTweakReader::ResolveFlatInstanceType(App::TweakChangeset& aChangeset,
                                                                         Red::TweakDBID aFlatId)
 {
-    const auto existingFlat = m_manager->GetFlat(aFlatId);
-    if (existingFlat.instance)
+    const auto existingFlatType = aChangeset.GetBaseFlatType(m_manager, aFlatId);
+    if (existingFlatType)
     {
-        return existingFlat.type;
+        return existingFlatType;
     }
 
     const auto pendingFlat = aChangeset.GetFlat(aFlatId);
@@ -139,7 +165,7 @@ const Red::CClass* App::BaseTweakReader::ResolveRecordInstanceType(App::TweakCha
     if (!aRecordId.IsValid())
         return nullptr;
 
-    const auto existingRecordType = m_manager->GetRecordType(aRecordId);
+    const auto existingRecordType = aChangeset.GetBaseRecordType(m_manager, aRecordId);
     if (existingRecordType)
     {
         return existingRecordType;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
+#include "App/Tweaks/Declarative/TweakCache.hpp"
 #include "App/Tweaks/TweakContext.hpp"
+#include "Core/Logging/LoggingAgent.hpp"
 
 namespace App
 {
@@ -13,14 +15,36 @@ public:
     [[nodiscard]] virtual bool IsLoaded() const = 0;
     virtual void Unload() = 0;
     virtual void Read(TweakChangeset& aChangeset) = 0;
+
+    // Warnings and errors reported by the reader are also added to the given list until it's reset.
+    virtual void CollectDiagnostics(Core::Vector<TweakCache::Diagnostic>* aDiagnostics) = 0;
 };
 
-class BaseTweakReader : public ITweakReader
+class BaseTweakReader
+    : public ITweakReader
+    , public Core::LoggingAgent
 {
 public:
     BaseTweakReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
 
+    void CollectDiagnostics(Core::Vector<TweakCache::Diagnostic>* aDiagnostics) override;
+
 protected:
+    void LogWarning(const char* aMessage);
+    void LogError(const char* aMessage);
+
+    template<typename... Args>
+    void LogWarning(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogWarning(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
+    template<typename... Args>
+    void LogError(std::format_string<Args...> aFormat, Args&&... aArgs)
+    {
+        LogError(std::format(aFormat, std::forward<Args>(aArgs)...).c_str());
+    }
+
     static std::string ComposePath(const std::string& aParentPath, const std::string& aItemName);
     static std::string ComposePath(const std::string& aParentPath, int32_t aItemIndex);
 
@@ -41,5 +65,6 @@ protected:
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
     Core::SharedPtr<App::TweakContext> m_context;
     Core::Map<std::string, int32_t> m_inlineIndexSuffix;
+    Core::Vector<TweakCache::Diagnostic>* m_diagnostics;
 };
 }
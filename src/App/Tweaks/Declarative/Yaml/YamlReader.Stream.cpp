@@ -0,0 +1,249 @@
+#include "YamlReader.hpp"
+
+#include <yaml-cpp/eventhandler.h>
+
+namespace
+{
+constexpr auto AttrSymbol = '$';
+
+// Builds nodes from parser events, but never keeps more than one top-level entry.
+// Each entry is passed to the handler as soon as its value is complete.
+class EntryStreamer : public YAML::EventHandler
+{
+public:
+    using Handler = std::function<void(const YAML::Node&, const YAML::Node&)>;
+
+    EntryStreamer(bool aAttributesOnly, const Handler& aHandler)
+        : m_attributesOnly(aAttributesOnly)
+        , m_handler(aHandler)
+        , m_skipDepth(0)
+        , m_rootStarted(false)
+        , m_rootIsMap(false)
+    {
+    }
+
+    [[nodiscard]] bool IsRootMap() const
+    {
+        return m_rootIsMap;
+    }
+
+    void OnDocumentStart(const YAML::Mark&) override
+    {
+    }
+
+    void OnDocumentEnd() override
+    {
+    }
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t aAnchor) override
+    {
+        if (Skip())
+            return;
+
+        Add(YAML::Node(YAML::NodeType::Null), aAnchor);
+    }
+
+    void OnAlias(const YAML::Mark&, YAML::anchor_t aAnchor) override
+    {
+        if (Skip())
+            return;
+
+        Add(m_anchors[aAnchor], YAML::NullAnchor);
+    }
+
+    void OnScalar(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                  const std::string& aValue) override
+    {
+        if (Skip())
+            return;
+
+        YAML::Node node(aValue);
+        node.SetTag(aTag);
+
+        Add(node, aAnchor);
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                         YAML::EmitterStyle::value aStyle) override
+    {
+        if (Skip(true))
+            return;
+
+        Push(YAML::NodeType::Sequence, aTag, aAnchor, aStyle);
+    }
+
+    void OnSequenceEnd() override
+    {
+        if (Skip(false, true))
+            return;
+
+        Pop();
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string& aTag, YAML::anchor_t aAnchor,
+                    YAML::EmitterStyle::value aStyle) override
+    {
+        if (Skip(true))
+            return;
+
+        Push(YAML::NodeType::Map, aTag, aAnchor, aStyle);
+    }
+
+    void OnMapEnd() override
+    {
+        if (Skip(false, true))
+            return;
+
+        Pop();
+    }
+
+private:
+    struct Frame
+    {
+        YAML::Node node;
+        std::optional<YAML::Node> key; // Assigning to a node would overwrite the referenced node
+    };
+
+    bool Skip(bool aEnter = false, bool aLeave = false)
+    {
+        if (m_skipDepth > 0)
+        {
+            if (aEnter)
+                ++m_skipDepth;
+            else if (aLeave)
+                --m_skipDepth;
+
+            return true;
+        }
+
+        // In attributes mode, values of other top-level entries are skipped without building nodes
+        if (m_attributesOnly && IsTopValue() && !IsAttributeKey(*m_stack.back().key))
+        {
+            m_stack.back().key.reset();
+
+            if (aEnter)
+                m_skipDepth = 1;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    [[nodiscard]] bool IsTopValue() const
+    {
+        return m_rootIsMap && m_stack.size() == 1 && m_stack.back().key.has_value();
+    }
+
+    static bool IsAttributeKey(const YAML::Node& aKey)
+    {
+        return aKey.IsScalar() && !aKey.Scalar().empty() && aKey.Scalar()[0] == AttrSymbol;
+    }
+
+    void Push(YAML::NodeType::value aType, const std::string& aTag, YAML::anchor_t aAnchor,
+              YAML::EmitterStyle::value aStyle)
+    {
+        if (!m_rootStarted)
+        {
+            m_rootStarted = true;
+            m_rootIsMap = (aType == YAML::NodeType::Map);
+        }
+
+        YAML::Node node(aType);
+        node.SetTag(aTag);
+        node.SetStyle(aStyle);
+
+        if (aAnchor != YAML::NullAnchor)
+        {
+            m_anchors[aAnchor] = node;
+        }
+
+        m_stack.push_back({node, {}});
+    }
+
+    void Pop()
+    {
+        auto node = m_stack.back().node;
+        m_stack.pop_back();
+
+        if (!m_stack.empty())
+        {
+            Add(node, YAML::NullAnchor);
+        }
+    }
+
+    void Add(const YAML::Node& aNode, YAML::anchor_t aAnchor)
+    {
+        if (aAnchor != YAML::NullAnchor)
+        {
+            m_anchors[aAnchor] = aNode;
+        }
+
+        if (m_stack.empty())
+        {
+            m_rootStarted = true;
+            return;
+        }
+
+        auto& frame = m_stack.back();
+
+        if (frame.node.IsSequence())
+        {
+            frame.node.push_back(aNode);
+            return;
+        }
+
+        if (!frame.key)
+        {
+            frame.key.emplace(aNode);
+            return;
+        }
+
+        if (m_rootIsMap && m_stack.size() == 1)
+        {
+            m_handler(*frame.key, aNode);
+        }
+        else
+        {
+            frame.node.force_insert(*frame.key, aNode);
+        }
+
+        frame.key.reset();
+    }
+
+    bool m_attributesOnly;
+    const Handler& m_handler;
+    Core::Vector<Frame> m_stack;
+    Core::Map<YAML::anchor_t, YAML::Node> m_anchors;
+    uint32_t m_skipDepth;
+    bool m_rootStarted;
+    bool m_rootIsMap;
+};
+}
+
+bool App::YamlReader::StreamEntries(const std::filesystem::path& aPath, bool aAttributesOnly,
+                                    const std::function<void(const YAML::Node&, const YAML::Node&)>& aHandler)
+{
+    std::ifstream in(aPath, std::ios::in);
+
+    if (!in.is_open())
+        return false;
+
+    EntryStreamer streamer(aAttributesOnly, aHandler);
+
+    YAML::Parser parser(in);
+    parser.HandleNextDocument(streamer);
+
+    return streamer.IsRootMap();
+}
+
+void App::YamlReader::ReadStream(App::TweakChangeset& aChangeset)
+{
+    const auto propMode = ResolvePropertyMode(m_data);
+
+    StreamEntries(m_path, false, [&](const YAML::Node& aKey, const YAML::Node& aValue) {
+        ProcessTemplate(aKey.Scalar(), aValue, [&](const std::string& aName, const YAML::Node& aNode) {
+            HandleTopNode(aChangeset, propMode, aName, aNode);
+        });
+    });
+}
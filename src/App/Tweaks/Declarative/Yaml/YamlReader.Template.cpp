@@ -1,4 +1,5 @@
 #include "YamlReader.hpp"
+#include "Core/Tracing/Tracer.hpp"
 
 namespace
 {
@@ -330,3 +331,54 @@ void App::YamlReader::ProcessTemplates(YAML::Node& aRootNode)
 
     aRootNode = expandedNode;
 }
+
+void App::YamlReader::ProcessTemplate(const std::string& aName, const YAML::Node& aNode,
+                                      const std::function<void(const std::string&, const YAML::Node&)>& aHandler)
+{
+    if (aNode.IsMap())
+    {
+        const auto& instanceListNode = aNode[InstanceAttrKey];
+
+        if (instanceListNode.IsDefined() && instanceListNode.IsSequence())
+        {
+            // The template is a shallow copy without the instance list, so the parsed entry stays intact
+            YAML::Node templateNode{YAML::NodeType::Map};
+            templateNode.SetTag(aNode.Tag());
+
+            for (const auto& nodeIt : aNode)
+            {
+                if (nodeIt.first.Scalar() != InstanceAttrKey)
+                {
+                    templateNode.force_insert(nodeIt.first, nodeIt.second);
+                }
+            }
+
+            // Instances are expanded one at a time, so only one copy of the template exists at once.
+            // Instances with the same name are all handled in order, like the duplicates of the expanded document.
+            for (std::size_t i = 0; i < instanceListNode.size(); ++i)
+            {
+                Core::TraceSpan span("Expanding templates", "Import");
+
+                InstanceData instanceData;
+                PrepareInstanceData(instanceData, instanceListNode[i]);
+
+                auto instanceName = FormatString(aName, instanceData);
+                auto instanceNode = YAML::Clone(templateNode);
+                ProcessNode(instanceNode, instanceData);
+
+                span.End();
+
+                aHandler(instanceName, instanceNode);
+            }
+
+            return;
+        }
+    }
+
+    {
+        Core::TraceSpan span("Expanding templates", "Import");
+        ProcessNode(aNode, s_blankInstanceData);
+    }
+
+    aHandler(aName, aNode);
+}
@@ -1,4 +1,5 @@
 #include "YamlReader.hpp"
+#include "Core/Tracing/Tracer.hpp"
 
 namespace
 {
@@ -31,18 +32,42 @@ constexpr auto LegacyMembersNodeKey = "members";
 constexpr auto LegacyFlatsNodeKey = "flats";
 constexpr auto LegacyTypeNodeKey = "type";
 constexpr auto LegacyValueNodeKey = "value";
+
+constexpr auto StreamingThreshold = 4 * 1024 * 1024;
 }
 
 App::YamlReader::YamlReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext)
     : BaseTweakReader(std::move(aManager), std::move(aContext))
     , m_path{}
     , m_data{}
+    , m_streaming(false)
 {
 }
 
 bool App::YamlReader::Load(const std::filesystem::path& aPath)
 {
     m_path = aPath;
+
+    std::error_code error;
+    m_streaming = std::filesystem::file_size(aPath, error) >= StreamingThreshold;
+
+    if (m_streaming)
+    {
+        // Collecting the attributes also parses the whole file,
+        // so syntax errors are still reported before anything is read.
+        YAML::Node attributes{YAML::NodeType::Map};
+
+        m_streaming = StreamEntries(aPath, true, [&attributes](const YAML::Node& aKey, const YAML::Node& aValue) {
+            attributes.force_insert(aKey, aValue);
+        });
+
+        if (m_streaming)
+        {
+            m_data = attributes;
+            return true;
+        }
+    }
+
     m_data = YAML::LoadFile(aPath.string());
 
     return IsLoaded();
@@ -57,6 +82,7 @@ void App::YamlReader::Unload()
 {
     m_path = "";
     m_data = YAML::Node();
+    m_streaming = false;
 }
 
 void App::YamlReader::Read(App::TweakChangeset& aChangeset)
@@ -73,8 +99,18 @@ void App::YamlReader::Read(App::TweakChangeset& aChangeset)
     if (!CheckConditions(m_data))
         return;
 
+    if (m_streaming)
+    {
+        ReadStream(aChangeset);
+        return;
+    }
+
     // ConvertLegacyNodes();
-    ProcessTemplates(m_data);
+
+    {
+        Core::TraceSpan span("Expanding templates", "Import");
+        ProcessTemplates(m_data);
+    }
 
     auto propMode = ResolvePropertyMode(m_data);
 
@@ -2,13 +2,11 @@
 
 #include "App/Tweaks/Batch/TweakChangeset.hpp"
 #include "App/Tweaks/Declarative/TweakReader.hpp"
-#include "Core/Logging/LoggingAgent.hpp"
 
 namespace App
 {
 class YamlReader
     : public BaseTweakReader
-    , public Core::LoggingAgent
 {
 public:
     YamlReader(Core::SharedPtr<Red::TweakDBManager> aManager, Core::SharedPtr<App::TweakContext> aContext);
@@ -63,9 +61,18 @@ private:
     std::pair<Red::CName, Red::InstancePtr<>> TryMakeValue(const YAML::Node& aNode);
 
     void ProcessTemplates(YAML::Node& aRootNode);
+    void ProcessTemplate(const std::string& aName, const YAML::Node& aNode,
+                         const std::function<void(const std::string&, const YAML::Node&)>& aHandler);
     void ConvertLegacyNodes();
 
+    // Large files are read entry by entry instead of loading the whole document.
+    // In this mode the loaded data only contains the top-level attributes.
+    void ReadStream(TweakChangeset& aChangeset);
+    static bool StreamEntries(const std::filesystem::path& aPath, bool aAttributesOnly,
+                              const std::function<void(const YAML::Node&, const YAML::Node&)>& aHandler);
+
     std::filesystem::path m_path;
     YAML::Node m_data;
+    bool m_streaming;
 };
 }
@@ -29,6 +29,46 @@ void App::ScriptManager::SetFlat(Red::IScriptable*, Red::CStackFrame* aFrame, bo
     }
 }
 
+void App::ScriptManager::SetFlats(Red::IScriptable*, Red::CStackFrame* aFrame, bool* aRet, void*)
+{
+    Red::DynArray<Red::TweakDBID> flatIDs;
+    Red::DynArray<Red::Variant> variants;
+
+    Red::GetParameter(aFrame, &flatIDs);
+    Red::GetParameter(aFrame, &variants);
+    aFrame->code++;
+
+    if (!s_manager || flatIDs.size != variants.size)
+        return;
+
+    Core::Vector<Red::TweakDBManager::FlatAssignment> assignments;
+    assignments.reserve(flatIDs.size);
+
+    auto success = true;
+
+    for (uint32_t i = 0; i < flatIDs.size; ++i)
+    {
+        auto& variant = variants[i];
+
+        if (variant.IsEmpty())
+        {
+            success = false;
+            continue;
+        }
+
+        ConvertScriptValueForFlatValue(variant, s_reflection);
+
+        assignments.emplace_back(flatIDs[i], Red::Value<>(variant.GetType(), variant.GetDataPtr()));
+    }
+
+    success = s_manager->SetFlats(assignments) && success;
+
+    if (aRet)
+    {
+        *aRet = success;
+    }
+}
+
 void App::ScriptManager::CreateRecord(Red::IScriptable*, Red::CStackFrame* aFrame, bool* aRet, void*)
 {
     Red::TweakDBID recordID;
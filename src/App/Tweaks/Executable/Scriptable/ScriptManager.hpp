@@ -15,6 +15,7 @@ public:
 
 private:
     static void SetFlat(Red::IScriptable* aContext, Red::CStackFrame* aFrame, bool* aRet, void*);
+    static void SetFlats(Red::IScriptable* aContext, Red::CStackFrame* aFrame, bool* aRet, void*);
     static void CreateRecord(Red::IScriptable* aContext, Red::CStackFrame* aFrame, bool* aRet, void*);
     static void CloneRecord(Red::IScriptable* aContext, Red::CStackFrame* aFrame, bool* aRet, void*);
     static void UpdateRecord(Red::IScriptable* aContext, Red::CStackFrame* aFrame, bool* aRet, void*);
@@ -38,6 +39,12 @@ RTTI_DEFINE_CLASS(App::ScriptManager, "TweakDBManager", {
         func->AddParam("Variant", "value");
         func->SetReturnType("Bool");
     }
+    {
+        auto func = type->AddFunction(&Type::SetFlats, "SetFlats", { .isFinal = true });
+        func->AddParam("array:TweakDBID", "paths");
+        func->AddParam("array:Variant", "values");
+        func->SetReturnType("Bool");
+    }
     {
         auto func = type->AddFunction(&Type::CreateRecord, "CreateRecord", { .isFinal = true });
         func->AddParam("TweakDBID", "path");
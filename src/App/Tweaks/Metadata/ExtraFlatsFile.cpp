@@ -0,0 +1,233 @@
+#include "ExtraFlatsFile.hpp"
+
+namespace
+{
+constexpr auto NameSeparator = '.';
+
+// Sequential reader that fails instead of reading past the end
+class DataReader
+{
+public:
+    explicit DataReader(std::span<const uint8_t> aData)
+        : m_data(aData)
+        , m_pos(0)
+    {
+    }
+
+    template<typename T>
+    bool Read(T& aValue)
+    {
+        if (m_data.size() - m_pos < sizeof(T))
+            return false;
+
+        std::memcpy(&aValue, m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& aValue, size_t aLength)
+    {
+        if (m_data.size() - m_pos < aLength)
+            return false;
+
+        aValue.assign(reinterpret_cast<const char*>(m_data.data() + m_pos), aLength);
+        m_pos += aLength;
+        return true;
+    }
+
+    [[nodiscard]] bool IsEnd() const
+    {
+        return m_pos == m_data.size();
+    }
+
+private:
+    std::span<const uint8_t> m_data;
+    size_t m_pos;
+};
+
+bool IsValidFlat(const Red::TweakDBExtraFlat& aFlat)
+{
+    return aFlat.appendix.size() > 1 && aFlat.appendix[0] == NameSeparator &&
+           Red::TweakDBReflection::GetFlatTypeInfo(aFlat.typeName) != nullptr;
+}
+}
+
+bool App::ExtraFlatsFile::Parse(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords)
+{
+    aRecords.clear();
+
+    if (aData.size() >= sizeof(Header) && reinterpret_cast<const Header*>(aData.data())->magic == Magic)
+    {
+        if (!ParseIndexed(aData, aRecords))
+        {
+            aRecords.clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!ParseLegacy(aData, aRecords))
+    {
+        aRecords.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool App::ExtraFlatsFile::ParseIndexed(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords)
+{
+    Header header;
+    std::memcpy(&header, aData.data(), sizeof(Header));
+
+    if (header.version != Version)
+        return false;
+
+    const auto typesOffset = sizeof(Header);
+    const auto flatsOffset = typesOffset + static_cast<uint64_t>(header.numberOfTypes) * sizeof(TypeEntry);
+    const auto stringsOffset = flatsOffset + static_cast<uint64_t>(header.numberOfFlats) * sizeof(FlatEntry);
+    const auto expectedSize = stringsOffset + header.stringTableSize;
+
+    if (aData.size() != expectedSize)
+        return false;
+
+    const auto payload = aData.subspan(sizeof(Header));
+
+    if (Red::FNV1a64(payload.data(), payload.size()) != header.checksum)
+        return false;
+
+    const auto* types = reinterpret_cast<const TypeEntry*>(aData.data() + typesOffset);
+    const auto* flats = reinterpret_cast<const FlatEntry*>(aData.data() + flatsOffset);
+    const auto* strings = reinterpret_cast<const char*>(aData.data() + stringsOffset);
+
+    aRecords.reserve(header.numberOfTypes);
+
+    for (uint32_t i = 0; i < header.numberOfTypes; ++i)
+    {
+        const auto& type = types[i];
+
+        if (type.firstFlat > header.numberOfFlats || type.numberOfFlats > header.numberOfFlats - type.firstFlat)
+            return false;
+
+        auto& record = aRecords.emplace_back();
+        record.recordType = type.recordType;
+        record.flats.reserve(type.numberOfFlats);
+
+        for (uint32_t j = type.firstFlat; j < type.firstFlat + type.numberOfFlats; ++j)
+        {
+            const auto& flat = flats[j];
+
+            if (flat.appendixOffset > header.stringTableSize ||
+                flat.appendixLength > header.stringTableSize - flat.appendixOffset)
+                return false;
+
+            auto& extraFlat = record.flats.emplace_back();
+            extraFlat.typeName = flat.flatType;
+            extraFlat.foreignTypeName = flat.foreignType;
+            extraFlat.appendix.assign(strings + flat.appendixOffset, flat.appendixLength);
+
+            if (!IsValidFlat(extraFlat))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool App::ExtraFlatsFile::ParseLegacy(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords)
+{
+    DataReader reader(aData);
+
+    uint64_t numberOfEntries;
+    if (!reader.Read(numberOfEntries))
+        return false;
+
+    while (numberOfEntries > 0)
+    {
+        auto& record = aRecords.emplace_back();
+        uint64_t numberOfFlats;
+
+        if (!reader.Read(record.recordType) || !reader.Read(numberOfFlats))
+            return false;
+
+        while (numberOfFlats > 0)
+        {
+            auto& extraFlat = record.flats.emplace_back();
+            uint8_t propNameLength;
+            std::string propName;
+
+            if (!reader.Read(propNameLength) || !reader.Read(propName, propNameLength) ||
+                !reader.Read(extraFlat.typeName) || !reader.Read(extraFlat.foreignTypeName))
+                return false;
+
+            extraFlat.appendix.reserve(propName.size() + 1);
+            extraFlat.appendix.push_back(NameSeparator);
+            extraFlat.appendix.append(propName);
+
+            if (!IsValidFlat(extraFlat))
+                return false;
+
+            --numberOfFlats;
+        }
+
+        --numberOfEntries;
+    }
+
+    return reader.IsEnd();
+}
+
+Core::Vector<uint8_t> App::ExtraFlatsFile::Serialize(std::span<const Record> aRecords)
+{
+    Core::Vector<TypeEntry> types;
+    Core::Vector<FlatEntry> flats;
+    std::string strings;
+    Core::Map<std::string, uint32_t> stringOffsets;
+
+    types.reserve(aRecords.size());
+
+    for (const auto& record : aRecords)
+    {
+        types.push_back({record.recordType, static_cast<uint32_t>(flats.size()),
+                         static_cast<uint32_t>(record.flats.size())});
+
+        for (const auto& extraFlat : record.flats)
+        {
+            // The same property names are used by many types
+            auto offsetIt = stringOffsets.find(extraFlat.appendix);
+            if (offsetIt == stringOffsets.end())
+            {
+                offsetIt = stringOffsets.emplace(extraFlat.appendix, static_cast<uint32_t>(strings.size())).first;
+                strings.append(extraFlat.appendix);
+            }
+
+            flats.push_back({extraFlat.typeName, extraFlat.foreignTypeName, offsetIt->second,
+                             static_cast<uint32_t>(extraFlat.appendix.size())});
+        }
+    }
+
+    Core::Vector<uint8_t> data(sizeof(Header) + types.size() * sizeof(TypeEntry) + flats.size() * sizeof(FlatEntry) +
+                               strings.size());
+
+    auto* out = data.data() + sizeof(Header);
+
+    std::memcpy(out, types.data(), types.size() * sizeof(TypeEntry));
+    out += types.size() * sizeof(TypeEntry);
+
+    std::memcpy(out, flats.data(), flats.size() * sizeof(FlatEntry));
+    out += flats.size() * sizeof(FlatEntry);
+
+    std::memcpy(out, strings.data(), strings.size());
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.numberOfTypes = static_cast<uint32_t>(types.size());
+    header.numberOfFlats = static_cast<uint32_t>(flats.size());
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+    header.checksum = Red::FNV1a64(data.data() + sizeof(Header), data.size() - sizeof(Header));
+
+    std::memcpy(data.data(), &header, sizeof(Header));
+
+    return data;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Red/TweakDB/Reflection.hpp"
+
+namespace App
+{
+// Binary format of the extra flats metadata.
+//
+// Layout (little endian):
+//   Header
+//   TypeEntry[numberOfTypes]   -- record type + span in the flat list
+//   FlatEntry[numberOfFlats]   -- flat type, foreign type and span in the string table
+//   char[stringTableSize]      -- appendices with the leading separator, shared between the types
+//
+// The checksum covers everything after the header, so a damaged file is rejected before any entry is used.
+// The legacy layout without a header is still accepted.
+class ExtraFlatsFile
+{
+public:
+    static constexpr uint32_t Magic = 0x46455854; // TXEF
+    static constexpr uint32_t Version = 2;
+
+    struct Record
+    {
+        Red::CName recordType;
+        Core::Vector<Red::TweakDBExtraFlat> flats;
+    };
+
+    // Returns false if the data is in neither layout or is damaged.
+    static bool Parse(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords);
+    static Core::Vector<uint8_t> Serialize(std::span<const Record> aRecords);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numberOfTypes;
+        uint32_t numberOfFlats;
+        uint32_t stringTableSize;
+        uint32_t reserved;
+        uint64_t checksum;
+    };
+
+    struct TypeEntry
+    {
+        Red::CName recordType;
+        uint32_t firstFlat;
+        uint32_t numberOfFlats;
+    };
+
+    struct FlatEntry
+    {
+        Red::CName flatType;
+        Red::CName foreignType;
+        uint32_t appendixOffset;
+        uint32_t appendixLength;
+    };
+
+    static_assert(sizeof(Header) == 32);
+    static_assert(sizeof(TypeEntry) == 16);
+    static_assert(sizeof(FlatEntry) == 24);
+
+    static bool ParseIndexed(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords);
+    static bool ParseLegacy(std::span<const uint8_t> aData, Core::Vector<Record>& aRecords);
+};
+}
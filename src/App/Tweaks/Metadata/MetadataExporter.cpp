@@ -1,5 +1,7 @@
 #include "MetadataExporter.hpp"
 #include "App/Tweaks/Declarative/Red/RedReader.hpp"
+#include "App/Tweaks/Metadata/ExtraFlatsFile.hpp"
+#include "Red/TweakDB/Inheritance.hpp"
 #include "Red/TweakDB/Manager.hpp"
 #include "Red/TweakDB/Source/Parser.hpp"
 
@@ -22,19 +24,77 @@ bool App::MetadataExporter::LoadSource(const std::filesystem::path& aSourceDir)
 {
     std::error_code error;
 
-    if (std::filesystem::exists(aSourceDir, error))
+    if (!std::filesystem::exists(aSourceDir, error))
+        return !m_sources.empty();
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    Core::Vector<std::filesystem::path> paths;
+
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(aSourceDir, error))
     {
-        for (const auto& entry : std::filesystem::recursive_directory_iterator(aSourceDir, error))
+        if (entry.is_regular_file() && entry.path().extension() == TweakExtension)
+        {
+            paths.push_back(entry.path());
+        }
+    }
+
+    if (paths.empty())
+        return !m_sources.empty();
+
+    // Every worker writes only to the slots of the files it parsed,
+    // so the sources are merged in the discovery order regardless of the timing
+    Core::Vector<Red::TweakSourcePtr> sources(paths.size());
+    Core::Vector<std::exception_ptr> errors(paths.size());
+    std::atomic_size_t nextIndex = 0;
+
+    auto worker = [&]() {
+        for (auto index = nextIndex++; index < paths.size(); index = nextIndex++)
         {
-            if (entry.is_regular_file() && entry.path().extension() == TweakExtension)
+            try
+            {
+                sources[index] = Red::TweakParser::Parse(paths[index]);
+            }
+            catch (...)
             {
-                m_sources.push_back(Red::TweakParser::Parse(entry.path()));
-                m_resolved = false;
+                errors[index] = std::current_exception();
             }
         }
+    };
+
+    const auto workerCount = std::clamp(std::thread::hardware_concurrency(), 1u, static_cast<uint32_t>(paths.size()));
+
+    Core::Vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+
+    for (auto i = 1u; i < workerCount; ++i)
+    {
+        threads.emplace_back(worker);
     }
 
-    return !m_sources.empty();
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Report the same error a serial pass would stop at
+    for (const auto& parseError : errors)
+    {
+        if (parseError)
+            std::rethrow_exception(parseError);
+    }
+
+    m_sources.insert(m_sources.end(), sources.begin(), sources.end());
+    m_resolved = false;
+
+    const auto endTime = std::chrono::steady_clock::now();
+
+    LogInfo("Parsed {} sources with {} workers in {} ms.", paths.size(), workerCount,
+            std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+
+    return true;
 }
 
 bool App::MetadataExporter::IsDebugGroup(const Red::TweakGroupPtr& aGroup)
@@ -238,26 +298,22 @@ bool App::MetadataExporter::ExportInheritanceMap(const std::filesystem::path& aO
 
     if (aOutPath.extension() == ".dat")
     {
-        std::ofstream out(aOutPath, std::ios::binary);
-
-        auto numberOfEntries = map.size();
-        out.write(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        Red::TweakDBInheritance::DescendantMap descendantMap;
 
         for (const auto& [recordName, childNames] : map)
         {
-            auto recordID = Red::TweakDBID(recordName);
-            auto numberOfChildren = childNames.size();
-
-            out.write(reinterpret_cast<char*>(&recordID), sizeof(recordID));
-            out.write(reinterpret_cast<char*>(&numberOfChildren), sizeof(numberOfChildren));
+            auto& descendantIDs = descendantMap[Red::TweakDBID(recordName)];
 
             for (const auto& childName : childNames)
             {
-                auto childID = Red::TweakDBID(childName);
-
-                out.write(reinterpret_cast<char*>(&childID), sizeof(childID));
+                descendantIDs.insert(Red::TweakDBID(childName));
             }
         }
+
+        const auto data = Red::TweakDBInheritance::Serialize(descendantMap);
+
+        std::ofstream out(aOutPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
     }
     else if (aOutPath.extension() == ".yaml")
     {
@@ -326,35 +382,31 @@ bool App::MetadataExporter::ExportExtraFlats(const std::filesystem::path& aOutPa
 
     if (aOutPath.extension() == ".dat")
     {
-        std::ofstream out(aOutPath, std::ios::binary);
-
-        auto numberOfEntries = extras.size();
-        out.write(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
+        Core::Vector<ExtraFlatsFile::Record> records;
+        records.reserve(extras.size());
 
         for (const auto& [schemaName, extraFlats] : extras)
         {
             std::string_view typeName = schemaName;
             typeName.remove_prefix(std::char_traits<char>::length(SchemaPackage) + 1);
 
-            auto recordType = m_reflection->GetRecordFullName(typeName.data());
-            auto numberOfFlats = extraFlats.size();
-
-            out.write(reinterpret_cast<char*>(&recordType), sizeof(recordType));
-            out.write(reinterpret_cast<char*>(&numberOfFlats), sizeof(numberOfFlats));
+            auto& record = records.emplace_back();
+            record.recordType = m_reflection->GetRecordFullName(typeName.data());
+            record.flats.reserve(extraFlats.size());
 
             for (const auto& [_, flat] : extraFlats)
             {
-                uint8_t flatNameLen = flat->name.size();
-                auto flatName = flat->name.data();
-                auto flatType = RedReader::GetFlatTypeName(flat);
-                auto foreignType = m_reflection->GetRecordFullName(flat->foreignType.data());
-
-                out.write(reinterpret_cast<char*>(&flatNameLen), sizeof(flatNameLen));
-                out.write(reinterpret_cast<char*>(flatName), flatNameLen);
-                out.write(reinterpret_cast<char*>(&flatType), sizeof(flatType));
-                out.write(reinterpret_cast<char*>(&foreignType), sizeof(foreignType));
+                auto& extraFlat = record.flats.emplace_back();
+                extraFlat.typeName = RedReader::GetFlatTypeName(flat);
+                extraFlat.foreignTypeName = m_reflection->GetRecordFullName(flat->foreignType.data());
+                extraFlat.appendix = NameSeparator + flat->name;
             }
         }
+
+        const auto data = ExtraFlatsFile::Serialize(records);
+
+        std::ofstream out(aOutPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
     }
     else if (aOutPath.extension() == ".yaml")
     {
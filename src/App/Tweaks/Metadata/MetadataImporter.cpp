@@ -1,4 +1,5 @@
 #include "MetadataImporter.hpp"
+#include "App/Tweaks/Metadata/ExtraFlatsFile.hpp"
 
 App::MetadataImporter::MetadataImporter(Core::SharedPtr<Red::TweakDBManager> aManager)
     : m_manager(std::move(aManager))
@@ -12,14 +13,26 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
     if (!std::filesystem::exists(aPath, error))
         return false;
 
+    auto inheritance = Core::MakeShared<Red::TweakDBInheritance>();
+
     if (aPath.extension() == ".dat")
     {
+        // The indexed layout is used in place without parsing
+        if (inheritance->Map(aPath))
+        {
+            m_reflection->RegisterInheritance(inheritance);
+            return true;
+        }
+
+        // Fall back to the legacy layout
         std::ifstream in(aPath, std::ios::binary);
 
         size_t numberOfEntries;
         in.read(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
 
-        while (numberOfEntries > 0)
+        Red::TweakDBInheritance::DescendantMap descendantMap;
+
+        while (numberOfEntries > 0 && in.good())
         {
             Red::TweakDBID recordID;
             size_t numberOfChildren;
@@ -27,9 +40,9 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
             in.read(reinterpret_cast<char*>(&recordID), sizeof(recordID));
             in.read(reinterpret_cast<char*>(&numberOfChildren), sizeof(numberOfChildren));
 
-            Core::Set<Red::TweakDBID> descendantIDs;
+            auto& descendantIDs = descendantMap[recordID];
 
-            while (numberOfChildren > 0)
+            while (numberOfChildren > 0 && in.good())
             {
                 Red::TweakDBID descendantID;
                 in.read(reinterpret_cast<char*>(&descendantID), sizeof(descendantID));
@@ -38,11 +51,15 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
                 --numberOfChildren;
             }
 
-            m_reflection->RegisterDescendants(recordID, descendantIDs);
-
             --numberOfEntries;
         }
 
+        if (!in.good())
+            return false;
+
+        inheritance->Build(descendantMap);
+        m_reflection->RegisterInheritance(inheritance);
+
         return true;
     }
 
@@ -52,7 +69,7 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
         if (!data.IsDefined() || !data.IsMap())
             return false;
 
-        Core::Set<Red::TweakDBID> descendantIDs;
+        Red::TweakDBInheritance::DescendantMap descendantMap;
 
         for (const auto& topNodeIt : data)
         {
@@ -66,7 +83,7 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
             if (!descendantNames.IsSequence())
                 return false;
 
-            descendantIDs.clear();
+            auto& descendantIDs = descendantMap[recordID];
 
             for (const auto& descendantName : descendantNames)
             {
@@ -80,10 +97,11 @@ bool App::MetadataImporter::ImportInheritanceMap(const std::filesystem::path& aP
 
             if (descendantIDs.empty())
                 return false;
-
-            m_reflection->RegisterDescendants(recordID, descendantIDs);
         }
 
+        inheritance->Build(descendantMap);
+        m_reflection->RegisterInheritance(inheritance);
+
         return true;
     }
 
@@ -98,40 +116,30 @@ bool App::MetadataImporter::ImportExtraFlats(const std::filesystem::path& aPath)
 
     if (aPath.extension() == ".dat")
     {
-        std::ifstream in(aPath, std::ios::binary);
+        std::ifstream in(aPath, std::ios::binary | std::ios::ate);
 
-        size_t numberOfEntries;
-        in.read(reinterpret_cast<char*>(&numberOfEntries), sizeof(numberOfEntries));
-
-        while (numberOfEntries > 0)
-        {
-            Red::CName recordType;
-            size_t numberOfFlats;
-
-            in.read(reinterpret_cast<char*>(&recordType), sizeof(recordType));
-            in.read(reinterpret_cast<char*>(&numberOfFlats), sizeof(numberOfFlats));
+        if (!in.is_open())
+            return false;
 
-            while (numberOfFlats > 0)
-            {
-                uint8_t propNameLen;
-                char propName[254];
-                Red::CName propType;
-                Red::CName foreignType;
+        Core::Vector<uint8_t> data(static_cast<size_t>(in.tellg()));
 
-                in.read(reinterpret_cast<char*>(&propNameLen), sizeof(propNameLen));
-                in.read(reinterpret_cast<char*>(&propName), propNameLen);
-                in.read(reinterpret_cast<char*>(&propType), sizeof(propType));
-                in.read(reinterpret_cast<char*>(&foreignType), sizeof(foreignType));
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
 
-                m_reflection->RegisterExtraFlat(recordType, {propName, propNameLen}, propType, foreignType);
+        if (!in.good())
+            return false;
 
-                --numberOfFlats;
-            }
+        // Nothing is registered unless the whole file is valid
+        Core::Vector<ExtraFlatsFile::Record> records;
+        if (!ExtraFlatsFile::Parse(data, records))
+            return false;
 
-            --numberOfEntries;
+        for (const auto& record : records)
+        {
+            m_reflection->RegisterExtraFlats(record.recordType, record.flats);
         }
 
-        return true ;
+        return true;
     }
 
     if (aPath.extension() == ".yaml")
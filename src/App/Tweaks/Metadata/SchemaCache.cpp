@@ -0,0 +1,195 @@
+#include "SchemaCache.hpp"
+
+namespace
+{
+constexpr uint32_t CacheMagic = 0x534C5854; // TXLS
+constexpr uint32_t CacheFormat = 1;
+
+constexpr uint32_t MaxStringLength = 1024;
+constexpr uint32_t MaxRecordCount = 64 * 1024;
+constexpr uint32_t MaxPropCount = 4 * 1024;
+
+template<typename T>
+inline bool Read(std::istream& aIn, T& aValue)
+{
+    aIn.read(reinterpret_cast<char*>(&aValue), sizeof(T));
+    return aIn.good();
+}
+
+template<typename T>
+inline void Write(std::ostream& aOut, const T& aValue)
+{
+    aOut.write(reinterpret_cast<const char*>(&aValue), sizeof(T));
+}
+
+inline bool ReadString(std::istream& aIn, std::string& aValue)
+{
+    uint32_t length;
+    if (!Read(aIn, length) || length > MaxStringLength)
+        return false;
+
+    aValue.resize(length);
+    aIn.read(aValue.data(), length);
+    return aIn.good();
+}
+
+inline void WriteString(std::ostream& aOut, std::string_view aValue)
+{
+    Write(aOut, static_cast<uint32_t>(aValue.size()));
+    aOut.write(aValue.data(), static_cast<std::streamsize>(aValue.size()));
+}
+}
+
+App::SchemaCache::SchemaCache(std::filesystem::path aPath, std::string aTag,
+                              Core::SharedPtr<Red::TweakDBReflection> aReflection)
+    : m_path(std::move(aPath))
+    , m_tag(std::move(aTag))
+    , m_reflection(std::move(aReflection))
+    , m_loaded(0)
+{
+}
+
+bool App::SchemaCache::Load()
+{
+    m_loaded = 0;
+
+    std::error_code error;
+    if (!std::filesystem::exists(m_path, error))
+        return false;
+
+    std::ifstream in(m_path, std::ios::binary);
+
+    uint32_t magic;
+    uint32_t format;
+    std::string tag;
+
+    if (!Read(in, magic) || magic != CacheMagic || !Read(in, format) || format != CacheFormat)
+    {
+        LogInfo("Schema cache has unsupported format, rebuilding...");
+        return false;
+    }
+
+    if (!ReadString(in, tag) || tag != m_tag)
+    {
+        LogInfo("Schema cache is outdated, rebuilding...");
+        return false;
+    }
+
+    uint32_t numberOfRecords;
+    if (!Read(in, numberOfRecords) || numberOfRecords > MaxRecordCount)
+        return false;
+
+    Core::Vector<Red::TweakDBRecordSchema> schema(numberOfRecords);
+
+    for (auto& record : schema)
+    {
+        if (!ReadRecord(in, record))
+        {
+            LogWarning("Schema cache is corrupted, rebuilding...");
+            return false;
+        }
+    }
+
+    // Mismatching types are discovered from the database as usual
+    m_loaded = m_reflection->ImportSchema(schema);
+
+    if (m_loaded != schema.size())
+    {
+        LogInfo("Schema cache has {} outdated record types.", schema.size() - m_loaded);
+    }
+
+    return true;
+}
+
+bool App::SchemaCache::Save()
+{
+    const auto schema = m_reflection->ExportSchema();
+
+    if (schema.size() <= m_loaded)
+        return true;
+
+    std::error_code error;
+    std::filesystem::create_directories(m_path.parent_path(), error);
+
+    auto tempPath = m_path;
+    tempPath += L".tmp";
+
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+
+        if (!out.is_open())
+        {
+            LogWarning("Can't write schema cache \"{}\".", m_path.string());
+            return false;
+        }
+
+        Write(out, CacheMagic);
+        Write(out, CacheFormat);
+        WriteString(out, m_tag);
+        Write(out, static_cast<uint32_t>(schema.size()));
+
+        for (const auto& record : schema)
+        {
+            WriteRecord(out, record);
+        }
+
+        if (!out.good())
+        {
+            LogWarning("Can't write schema cache \"{}\".", m_path.string());
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tempPath, m_path, error);
+
+    if (error)
+    {
+        LogWarning("Can't write schema cache \"{}\": {}.", m_path.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    m_loaded = static_cast<uint32_t>(schema.size());
+
+    return true;
+}
+
+bool App::SchemaCache::ReadRecord(std::istream& aIn, Red::TweakDBRecordSchema& aRecord)
+{
+    if (!Read(aIn, aRecord.typeName.hash) || !Read(aIn, aRecord.parentName.hash) || !Read(aIn, aRecord.typeHash) ||
+        !Read(aIn, aRecord.funcCount))
+        return false;
+
+    uint32_t numberOfProps;
+    if (!Read(aIn, numberOfProps) || numberOfProps > MaxPropCount)
+        return false;
+
+    aRecord.props.resize(numberOfProps);
+
+    for (auto& prop : aRecord.props)
+    {
+        if (!Read(aIn, prop.typeName.hash) || !Read(aIn, prop.foreignTypeName.hash) ||
+            !ReadString(aIn, prop.appendix) || !Read(aIn, prop.dataOffset) || !Read(aIn, prop.defaultId))
+            return false;
+    }
+
+    return true;
+}
+
+void App::SchemaCache::WriteRecord(std::ostream& aOut, const Red::TweakDBRecordSchema& aRecord)
+{
+    Write(aOut, aRecord.typeName.hash);
+    Write(aOut, aRecord.parentName.hash);
+    Write(aOut, aRecord.typeHash);
+    Write(aOut, aRecord.funcCount);
+    Write(aOut, static_cast<uint32_t>(aRecord.props.size()));
+
+    for (const auto& prop : aRecord.props)
+    {
+        Write(aOut, prop.typeName.hash);
+        Write(aOut, prop.foreignTypeName.hash);
+        WriteString(aOut, prop.appendix);
+        Write(aOut, prop.dataOffset);
+        Write(aOut, prop.defaultId);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Core/Logging/LoggingAgent.hpp"
+#include "Red/TweakDB/Reflection.hpp"
+
+namespace App
+{
+// Record types discovered in previous sessions.
+// The schema only depends on the game, so the cache is tagged with the game version.
+class SchemaCache : Core::LoggingAgent
+{
+public:
+    SchemaCache(std::filesystem::path aPath, std::string aTag, Core::SharedPtr<Red::TweakDBReflection> aReflection);
+
+    // Imports the cached record types into the reflection.
+    bool Load();
+
+    // Stores the record types known to the reflection, if there are any new ones.
+    bool Save();
+
+private:
+    bool ReadRecord(std::istream& aIn, Red::TweakDBRecordSchema& aRecord);
+    void WriteRecord(std::ostream& aOut, const Red::TweakDBRecordSchema& aRecord);
+
+    std::filesystem::path m_path;
+    std::string m_tag;
+    Core::SharedPtr<Red::TweakDBReflection> m_reflection;
+    uint32_t m_loaded;
+};
+}
@@ -30,6 +30,19 @@ public:
         return aCondition.empty();
     }
 
+    // Identifies the conditions that affect the outcome of reading a tweak.
+    [[nodiscard]] inline std::string GetStateTag() const
+    {
+        auto tag = m_gameVersion.to_string();
+
+        if (m_isEpisodeOne)
+        {
+            tag.append("+EP1");
+        }
+
+        return tag;
+    }
+
 private:
     semver::version m_gameVersion;
     bool m_isEpisodeOne;
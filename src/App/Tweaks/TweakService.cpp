@@ -1,8 +1,11 @@
 #include "TweakService.hpp"
+#include "App/Project.hpp"
 #include "App/Tweaks/Declarative/TweakImporter.hpp"
 #include "App/Tweaks/Executable/TweakExecutor.hpp"
 #include "App/Tweaks/Metadata/MetadataExporter.hpp"
 #include "App/Tweaks/Metadata/MetadataImporter.hpp"
+#include "App/Tweaks/Metadata/SchemaCache.hpp"
+#include "Core/Tracing/Tracer.hpp"
 #include "Red/TweakDB/Raws.hpp"
 
 App::TweakService::TweakService(const Core::SemvVer& aProductVer, std::filesystem::path aGameDir,
@@ -29,14 +32,56 @@ void App::TweakService::OnBootstrap()
             m_manager = Core::MakeShared<Red::TweakDBManager>(m_reflection);
             m_context = Core::MakeShared<App::TweakContext>(m_productVer);
             m_importer = Core::MakeShared<App::TweakImporter>(m_manager, m_context);
+            m_importer->SetWorkerCount(m_importWorkers);
+            m_importer->SetChangeTracking(m_incrementalReload);
             m_executor = Core::MakeShared<App::TweakExecutor>(m_manager);
             m_changelog = Core::MakeShared<App::TweakChangelog>();
 
             if (ImportMetadata())
             {
+                // The record types are restored before anything can request them
+                Core::SharedPtr<App::SchemaCache> schemaCache;
+                if (!m_schemaCachePath.empty())
+                {
+                    schemaCache = Core::MakeShared<App::SchemaCache>(m_schemaCachePath, ComposeCacheTag(),
+                                                                     m_reflection);
+                    schemaCache->Load();
+                }
+
+                if (m_recordWarmUp)
+                {
+                    m_reflection->WarmUp(m_importWorkers ? m_importWorkers : std::thread::hardware_concurrency());
+                }
+
                 EnsureRuntimeAccess();
                 ApplyPatches();
+
+                if (!m_importCachePath.empty())
+                {
+                    auto cache = Core::MakeShared<App::TweakCache>(m_importCachePath, ComposeCacheTag(),
+                                                                   m_reflection);
+                    cache->Load();
+
+                    m_importer->SetCache(std::move(cache));
+                }
+
                 LoadTweaks(false);
+                ReportRecordResolving();
+
+                // The import touches most of the record types, so the cache is complete enough after it
+                if (schemaCache)
+                {
+                    schemaCache->Save();
+                }
+
+                // The cached changes are only valid for the pristine database,
+                // reloads must read the tweaks from scratch
+                m_importer->SetCache(nullptr);
+
+                m_manager->SaveCheckpoint();
+
+                ExportTrace();
+                ReportNameUsage();
             }
         }
     });
@@ -61,6 +106,29 @@ void App::TweakService::LoadTweaks(bool aCheckForIssues)
     }
 }
 
+void App::TweakService::ReloadTweaks()
+{
+    if (m_manager)
+    {
+        // The game or third parties may have replaced or extended the flat buffer since the last import,
+        // so the buffer verifies its last scan before anything is allocated
+        m_manager->Invalidate();
+
+        if (!m_importer->ImportChanges(m_importPaths, m_changelog))
+        {
+            m_importer->ImportTweaks(m_importPaths, m_changelog);
+        }
+
+        m_executor->ExecuteTweaks();
+        m_changelog->CheckForIssues(m_manager);
+        m_manager->SaveCheckpoint();
+
+        ExportTrace();
+        ReportBufferUsage();
+        ReportNameUsage();
+    }
+}
+
 void App::TweakService::ImportTweaks()
 {
     if (m_manager)
@@ -102,6 +170,51 @@ void App::TweakService::ApplyPatches()
     }
 }
 
+void App::TweakService::ExportTrace()
+{
+    if (Core::Tracer::IsEnabled() && !m_tracePath.empty())
+    {
+        if (!Core::Tracer::Export(m_tracePath))
+        {
+            LogWarning("Can't write trace \"{}\".", m_tracePath.string());
+            return;
+        }
+
+        // Each export only contains the spans since the previous one, so reloads don't repeat the startup
+        Core::Tracer::Clear();
+    }
+}
+
+void App::TweakService::ReportRecordResolving()
+{
+    const auto stats = m_reflection->GetResolveStats();
+
+    if (stats.warmedTypes > 0)
+    {
+        LogInfo("Record types: {} warmed up in {} ms at boot, {} ms of collection moved off the import.",
+                stats.warmedTypes, stats.warmUpTime / 1000000, stats.warmUpWork / 1000000);
+    }
+
+    LogInfo("Record types: {} collected on request in {} ms.", stats.lazyTypes, stats.lazyTime / 1000000);
+}
+
+std::string App::TweakService::ComposeCacheTag()
+{
+    // The metadata files are part of the tag, so editing them invalidates the caches built with the old content
+    auto tag = std::format("{}|{}", Project::Version.to_string(), m_context->GetStateTag());
+
+    for (const auto& metadataPath : {m_extraFlatsPath, m_inheritanceMapPath})
+    {
+        uint64_t size = 0;
+        uint64_t hash = 0;
+        TweakCache::ComputeKey(metadataPath, size, hash);
+
+        tag.append(std::format("|{}:{:016X}", size, hash));
+    }
+
+    return tag;
+}
+
 void App::TweakService::CheckForIssues()
 {
     if (m_manager && m_changelog)
@@ -110,6 +223,55 @@ void App::TweakService::CheckForIssues()
     }
 }
 
+void App::TweakService::ReportBufferUsage()
+{
+    if (m_manager)
+    {
+        const auto usage = m_manager->GetBufferUsage();
+
+        LogInfo("Flat buffer holds {} values in {} KiB, {} values in {} KiB are no longer referenced.",
+                usage.values, usage.bytes / 1024, usage.deadValues, usage.deadBytes / 1024);
+
+        for (const auto& typeUsage : usage.types)
+        {
+            if (typeUsage.deadValues > 0)
+            {
+                LogDebug("{}: {} of {} values, {} of {} KiB unreferenced.", typeUsage.type.ToString(),
+                         typeUsage.deadValues, typeUsage.values, typeUsage.deadBytes / 1024, typeUsage.bytes / 1024);
+            }
+        }
+    }
+}
+
+void App::TweakService::ReportNameUsage()
+{
+    if (m_manager)
+    {
+        const auto stats = m_manager->GetNameStats();
+
+        LogInfo("Name table holds {} names ({} shared, {} resolved) in {} KiB, index uses {} KiB.",
+                stats.names + stats.resolvedNames, stats.sharedNames, stats.resolvedNames,
+                stats.arenaUsed / 1024, stats.indexSize / 1024);
+    }
+}
+
+void App::TweakService::CompactBuffer()
+{
+    if (m_manager)
+    {
+        const auto releasedBytes = m_manager->CompactBuffer();
+
+        if (!releasedBytes)
+        {
+            LogWarning("Flat buffer can't be compacted at this point, check that no tweaks are being applied "
+                       "and all flats point to valid values.");
+            return;
+        }
+
+        LogInfo("Flat buffer compacted, {} KiB released.", *releasedBytes / 1024);
+    }
+}
+
 void App::TweakService::CreateTweaksDir()
 {
     std::error_code error;
@@ -166,6 +328,8 @@ bool App::TweakService::RegisterDirectory(std::filesystem::path aPath)
 
 bool App::TweakService::ImportMetadata()
 {
+    Core::TraceSpan span("Importing metadata", "Metadata");
+
     MetadataImporter importer{m_manager};
 
     LogInfo("Loading inheritance metadata...");
@@ -189,6 +353,9 @@ bool App::TweakService::ImportMetadata()
 
 void App::TweakService::ExportMetadata()
 {
+    // The current inheritance map can be mapped from the file that is about to be overwritten
+    m_reflection->DetachInheritance();
+
     MetadataExporter exporter{m_manager};
     exporter.LoadSource(m_sourcesDir);
     exporter.ExportInheritanceMap(m_inheritanceMapPath, true);
@@ -27,14 +27,54 @@ public:
     bool RegisterDirectory(std::filesystem::path aPath);
 
     void LoadTweaks(bool aCheckForIssues);
+    void ReloadTweaks();
     void ImportTweaks();
     void ExecuteTweaks();
     void ExecuteTweak(Red::CName aName);
     void CheckForIssues();
+    void ReportBufferUsage();
+    void ReportNameUsage();
+    void CompactBuffer();
 
     bool ImportMetadata();
     void ExportMetadata();
 
+    auto SetImportWorkers(uint32_t aWorkerCount) noexcept
+    {
+        m_importWorkers = aWorkerCount;
+        return Defer(this);
+    }
+
+    auto SetTracePath(std::filesystem::path aTracePath) noexcept
+    {
+        m_tracePath = std::move(aTracePath);
+        return Defer(this);
+    }
+
+    auto EnableIncrementalReload() noexcept
+    {
+        m_incrementalReload = true;
+        return Defer(this);
+    }
+
+    auto EnableImportCache(std::filesystem::path aCachePath) noexcept
+    {
+        m_importCachePath = std::move(aCachePath);
+        return Defer(this);
+    }
+
+    auto EnableSchemaCache(std::filesystem::path aCachePath) noexcept
+    {
+        m_schemaCachePath = std::move(aCachePath);
+        return Defer(this);
+    }
+
+    auto EnableRecordWarmUp() noexcept
+    {
+        m_recordWarmUp = true;
+        return Defer(this);
+    }
+
     Red::TweakDBManager& GetManager();
     Red::TweakDBReflection& GetReflection();
     App::TweakChangelog& GetChangelog();
@@ -44,6 +84,9 @@ protected:
     void CreateTweaksDir();
     void EnsureRuntimeAccess();
     void ApplyPatches();
+    void ExportTrace();
+    void ReportRecordResolving();
+    std::string ComposeCacheTag();
 
     std::filesystem::path m_gameDir;
     std::filesystem::path m_tweaksDir;
@@ -51,6 +94,12 @@ protected:
     std::filesystem::path m_inheritanceMapPath;
     std::filesystem::path m_extraFlatsPath;
     const Core::SemvVer& m_productVer;
+    std::filesystem::path m_importCachePath;
+    std::filesystem::path m_schemaCachePath;
+    std::filesystem::path m_tracePath;
+    uint32_t m_importWorkers{0};
+    bool m_incrementalReload{false};
+    bool m_recordWarmUp{false};
     Core::Vector<std::filesystem::path> m_importPaths;
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
     Core::SharedPtr<Red::TweakDBManager> m_manager;
@@ -34,6 +34,30 @@ const std::array<Red::CName, 26> s_flatTypes = {
     Red::ERTDBFlatType::Vector2Array,
     Red::ERTDBFlatType::ColorArray,
 };
+
+constexpr std::array<uint64_t, 10> s_fixedFlatTypes = {
+    Red::ERTDBFlatType::Int,
+    Red::ERTDBFlatType::Float,
+    Red::ERTDBFlatType::Bool,
+    Red::ERTDBFlatType::TweakDBID,
+    Red::ERTDBFlatType::CName,
+    Red::ERTDBFlatType::Vector2,
+    Red::ERTDBFlatType::Vector3,
+    Red::ERTDBFlatType::Quaternion,
+    Red::ERTDBFlatType::EulerAngles,
+    Red::ERTDBFlatType::Color,
+};
+
+constexpr size_t GetFixedIndex(uint64_t aTypeName)
+{
+    for (size_t i = 0; i < s_fixedFlatTypes.size(); ++i)
+    {
+        if (s_fixedFlatTypes[i] == aTypeName)
+            return i;
+    }
+
+    return s_fixedFlatTypes.size();
+}
 }
 
 Red::TweakDBBuffer::TweakDBBuffer()
@@ -42,9 +66,20 @@ Red::TweakDBBuffer::TweakDBBuffer()
 }
 
 Red::TweakDBBuffer::TweakDBBuffer(Red::TweakDB* aTweakDb)
+    : TweakDBBuffer(aTweakDb, Red::TweakDBHasher::Get())
+{
+}
+
+Red::TweakDBBuffer::TweakDBBuffer(Red::TweakDB* aTweakDb, Red::TweakDBHasher::Function aHasher)
     : m_tweakDb(aTweakDb)
+    , m_hasher(aHasher)
+    , m_fixedTypes{}
     , m_bufferEnd(0)
     , m_offsetEnd(0)
+    , m_checkpoint{}
+    , m_validateCheckpoint(false)
+    , m_readContentions(0)
+    , m_writeContentions(0)
 {
 }
 
@@ -55,17 +90,116 @@ int32_t Red::TweakDBBuffer::AllocateValue(const Red::Value<>& aData)
 
 int32_t Red::TweakDBBuffer::AllocateValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance)
 {
-    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+    if (IsBufferChanged())
         SyncBufferData();
 
-    auto& pool = m_pools.at(aType->GetName());
     const auto hash = ComputeHash(aType, aInstance);
+    auto& pool = *m_pools.at(aType->GetName());
+
+    {
+        const auto offset = FindValue(pool, hash);
+        if (offset != InvalidOffset)
+            return offset;
+    }
+
+    return InsertValue(pool, hash, aType, aInstance);
+}
+
+int32_t Red::TweakDBBuffer::AssignValue(int32_t aOffset, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
+{
+    switch (aType->GetName().hash)
+    {
+    case Red::ERTDBFlatType::Int:
+        return AssignFixedValue<int32_t, GetFixedIndex(Red::ERTDBFlatType::Int)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::Float:
+        return AssignFixedValue<float, GetFixedIndex(Red::ERTDBFlatType::Float)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::Bool:
+        return AssignFixedValue<bool, GetFixedIndex(Red::ERTDBFlatType::Bool)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::TweakDBID:
+        return AssignFixedValue<Red::TweakDBID, GetFixedIndex(Red::ERTDBFlatType::TweakDBID)>(aOffset, aType,
+                                                                                              aInstance);
+    case Red::ERTDBFlatType::CName:
+        return AssignFixedValue<Red::CName, GetFixedIndex(Red::ERTDBFlatType::CName)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::Vector2:
+        return AssignFixedValue<Red::Vector2, GetFixedIndex(Red::ERTDBFlatType::Vector2)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::Vector3:
+        return AssignFixedValue<Red::Vector3, GetFixedIndex(Red::ERTDBFlatType::Vector3)>(aOffset, aType, aInstance);
+    case Red::ERTDBFlatType::Quaternion:
+        return AssignFixedValue<Red::Quaternion, GetFixedIndex(Red::ERTDBFlatType::Quaternion)>(aOffset, aType,
+                                                                                                aInstance);
+    case Red::ERTDBFlatType::EulerAngles:
+        return AssignFixedValue<Red::EulerAngles, GetFixedIndex(Red::ERTDBFlatType::EulerAngles)>(aOffset, aType,
+                                                                                                  aInstance);
+    case Red::ERTDBFlatType::Color:
+        return AssignFixedValue<Red::Color, GetFixedIndex(Red::ERTDBFlatType::Color)>(aOffset, aType, aInstance);
+    }
+
+    if (aOffset >= 0)
+    {
+        const auto value = GetValue(aOffset);
+
+        if (value.type != aType)
+            return InvalidOffset;
+
+        if (value.type->IsEqual(value.instance, aInstance))
+            return aOffset;
+    }
+
+    return AllocateValue(aType, aInstance);
+}
+
+template<typename T, size_t AIndex>
+int32_t Red::TweakDBBuffer::AssignFixedValue(int32_t aOffset, const Red::CBaseRTTIType* aType,
+                                             Red::Instance aInstance)
+{
+    static_assert(AIndex < FixedTypeCount);
+
+    if (IsBufferChanged())
+        SyncBufferData();
+
+    const auto& fixedType = m_fixedTypes[AIndex];
+
+    // Same as the generic path, but the type is checked by VFT,
+    // and the value is compared and hashed as a block of known size.
+    if (aOffset >= 0)
+    {
+        const auto addr = m_tweakDb->flatDataBuffer + aOffset;
+
+        if (*reinterpret_cast<uintptr_t*>(addr) != fixedType.vft)
+            return InvalidOffset;
+
+        if (std::memcmp(reinterpret_cast<void*>(addr + fixedType.offset), aInstance, sizeof(T)) == 0)
+            return aOffset;
+    }
+
+    const auto hash = m_hasher(reinterpret_cast<const uint8_t*>(aInstance), sizeof(T), HashSeed);
+    auto& pool = *fixedType.pool;
+
+    {
+        const auto offset = FindValue(pool, hash);
+        if (offset != InvalidOffset)
+            return offset;
+    }
+
+    return InsertValue(pool, hash, aType, aInstance);
+}
+
+int32_t Red::TweakDBBuffer::InsertValue(FlatPool& aPool, uint64_t aHash, const Red::CBaseRTTIType* aType,
+                                        Red::Instance aInstance)
+{
+    // New values are appended to the game buffer one at a time,
+    // the lock also prevents the same value from being created twice.
+    std::unique_lock allocLock(m_allocMutex, std::try_to_lock);
+    if (!allocLock.owns_lock())
+    {
+        ++m_writeContentions;
+        allocLock.lock();
+    }
 
     {
-        std::shared_lock poolLockR(m_poolMutex);
-        const auto offsetIt = pool.find(hash);
-        if (offsetIt != pool.end())
-            return offsetIt->second;
+        const auto offset = FindValue(aPool, aHash);
+        if (offset != InvalidOffset)
+            return offset;
     }
 
     const auto offset = m_tweakDb->CreateFlatValue({const_cast<Red::CBaseRTTIType*>(aType), aInstance});
@@ -74,16 +208,38 @@ int32_t Red::TweakDBBuffer::AllocateValue(const Red::CBaseRTTIType* aType, Red::
 
     if (offset > 0)
     {
-        std::unique_lock poolLockRW(m_poolMutex);
-        pool.emplace(hash, offset);
+        std::unique_lock poolLockRW(aPool.mutex, std::try_to_lock);
+        if (!poolLockRW.owns_lock())
+        {
+            ++m_writeContentions;
+            poolLockRW.lock();
+        }
+
+        aPool.values.emplace(aHash, offset);
     }
 
     return offset;
 }
 
+int32_t Red::TweakDBBuffer::FindValue(FlatPool& aPool, uint64_t aHash)
+{
+    std::shared_lock poolLockR(aPool.mutex, std::try_to_lock);
+    if (!poolLockR.owns_lock())
+    {
+        ++m_readContentions;
+        poolLockR.lock();
+    }
+
+    const auto offsetIt = aPool.values.find(aHash);
+    if (offsetIt != aPool.values.end())
+        return offsetIt->second;
+
+    return InvalidOffset;
+}
+
 int32_t Red::TweakDBBuffer::AllocateDefault(const Red::CBaseRTTIType* aType)
 {
-    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+    if (IsBufferChanged())
         SyncBufferData();
 
     return m_defaults.at(aType->GetName());
@@ -94,7 +250,7 @@ Red::Value<> Red::TweakDBBuffer::GetValue(int32_t aOffset)
     if (aOffset < 0)
         return {};
 
-    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+    if (IsBufferChanged())
         SyncBufferData();
 
     return ResolveOffset(aOffset);
@@ -105,7 +261,7 @@ Red::Instance Red::TweakDBBuffer::GetValuePtr(int32_t aOffset)
     if (aOffset < 0)
         return {};
 
-    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+    if (IsBufferChanged())
         SyncBufferData();
 
     return ResolveOffset(aOffset).instance;
@@ -116,7 +272,7 @@ uint64_t Red::TweakDBBuffer::GetValueHash(int32_t aOffset)
     if (aOffset < 0)
         return {};
 
-    if (m_bufferEnd != m_tweakDb->flatDataBufferEnd)
+    if (IsBufferChanged())
         SyncBufferData();
 
     const auto data = ResolveOffset(aOffset);
@@ -124,7 +280,8 @@ uint64_t Red::TweakDBBuffer::GetValueHash(int32_t aOffset)
     return ComputeHash(data.type, data.instance);
 }
 
-uint64_t Red::TweakDBBuffer::ComputeHash(const Red::CBaseRTTIType* aType, Red::Instance aInstance, uint64_t aSeed)
+uint64_t Red::TweakDBBuffer::ComputeHash(const Red::CBaseRTTIType* aType, Red::Instance aInstance,
+                                         uint64_t aSeed) const
 {
     // Case 1: Everything is processed as a sequence of bytes and passed to the hash function,
     //         except for an array of strings.
@@ -136,12 +293,17 @@ uint64_t Red::TweakDBBuffer::ComputeHash(const Red::CBaseRTTIType* aType, Red::I
 
     uint64_t hash;
 
-    if (aType->GetType() == Red::ERTTIType::Array)
-    {
-        auto* arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(aType);
-        auto* innerType = arrayType->GetInnerType();
+    // The flat types are classified with a single lookup instead of querying the RTTI
+    const auto* typeInfo = Red::TweakDBReflection::GetFlatTypeInfo(aType->GetName());
 
-        if (innerType->GetName() == "String")
+    if (!typeInfo)
+    {
+        const auto* data = reinterpret_cast<const uint8_t*>(aInstance);
+        hash = m_hasher(data, aType->GetSize(), aSeed);
+    }
+    else if (typeInfo->isArray)
+    {
+        if (typeInfo->isString)
         {
             const auto* array = reinterpret_cast<Red::DynArray<Red::CString>*>(aInstance);
             hash = aSeed;
@@ -149,26 +311,26 @@ uint64_t Red::TweakDBBuffer::ComputeHash(const Red::CBaseRTTIType* aType, Red::I
             {
                 const auto* str = array->entries + i;
                 const auto length = str->Length();
-                hash = FNV1a64(reinterpret_cast<const uint8_t*>(&length), sizeof(length), hash);
-                hash = FNV1a64(reinterpret_cast<const uint8_t*>(str->c_str()), length, hash);
+                hash = m_hasher(reinterpret_cast<const uint8_t*>(&length), sizeof(length), hash);
+                hash = m_hasher(reinterpret_cast<const uint8_t*>(str->c_str()), length, hash);
             }
         }
         else
         {
             const auto* array = reinterpret_cast<Red::DynArray<uint8_t>*>(aInstance);
-            hash = FNV1a64(array->entries, array->size * innerType->GetSize(), aSeed);
+            hash = m_hasher(array->entries, array->size * typeInfo->elementSize, aSeed);
         }
     }
-    else if (aType->GetName() == "String")
+    else if (typeInfo->isString)
     {
         const auto* str = reinterpret_cast<Red::CString*>(aInstance);
         const auto* data = reinterpret_cast<const uint8_t*>(str->c_str());
-        hash = FNV1a64(data, str->Length(), aSeed);
+        hash = m_hasher(data, str->Length(), aSeed);
     }
     else
     {
         const auto* data = reinterpret_cast<const uint8_t*>(aInstance);
-        hash = FNV1a64(data, aType->GetSize(), aSeed);
+        hash = m_hasher(data, typeInfo->size, aSeed);
     }
 
     return hash;
@@ -181,11 +343,15 @@ Red::Value<> Red::TweakDBBuffer::ResolveOffset(int32_t aOffset)
 
     const auto addr = m_tweakDb->flatDataBuffer + aOffset;
     const auto vft = *reinterpret_cast<uintptr_t*>(addr);
-    const auto it = m_types.find(vft);
 
-    // For a known VFT we can immediately get RTTI type and data pointer.
-    if (it != m_types.end())
-        return { it->second.type, reinterpret_cast<void*>(addr + it->second.offset) };
+    {
+        std::shared_lock typeLockR(m_typeMutex);
+        const auto it = m_types.find(vft);
+
+        // For a known VFT we can immediately get RTTI type and data pointer.
+        if (it != m_types.end())
+            return { it->second.type, reinterpret_cast<void*>(addr + it->second.offset) };
+    }
 
     // For an unknown VFT, we call the virtual GetValue() once to get the type.
     const auto data = reinterpret_cast<TweakDBFlatValue*>(addr)->GetValue();
@@ -194,11 +360,19 @@ Red::Value<> Red::TweakDBBuffer::ResolveOffset(int32_t aOffset)
     // In addition to the RTTI type, we also store the data offset considering alignment.
     // Quaternion is 16-byte aligned, so there is 8-byte padding between the VFT and the data:
     // [ 8B VFT ][ 8B PAD ][ 16B QUATERNION ]
-    m_types.insert({ vft, { data.type, std::max(data.type->GetAlignment(), FlatAlignment) } });
+    {
+        std::unique_lock typeLockRW(m_typeMutex);
+        m_types.insert({ vft, { data.type, std::max(data.type->GetAlignment(), FlatAlignment) } });
+    }
 
     return data;
 }
 
+bool Red::TweakDBBuffer::IsBufferChanged() const
+{
+    return m_bufferEnd != m_tweakDb->flatDataBufferEnd;
+}
+
 void Red::TweakDBBuffer::CreatePools()
 {
     if (m_pools.size() != s_flatTypes.size())
@@ -207,7 +381,7 @@ void Red::TweakDBBuffer::CreatePools()
 
         for (const auto& typeName : s_flatTypes)
         {
-            m_pools.emplace(typeName, 0);
+            m_pools.emplace(typeName, Core::MakeUnique<FlatPool>());
         }
     }
 }
@@ -218,40 +392,87 @@ void Red::TweakDBBuffer::FillDefaults()
     {
         for (const auto& typeName : s_flatTypes)
         {
-            auto& pool = m_pools.at(typeName);
-
             const auto value = Red::MakeValue(typeName);
             const auto hash = ComputeHash(value->type, value->instance);
-            const auto it = pool.find(hash);
 
-            int32_t offset = -1;
+            auto& pool = *m_pools.at(typeName);
+            auto offset = FindValue(pool, hash);
 
-            if (it != pool.end())
-            {
-                offset = it->second;
-            }
-            else
+            if (offset == InvalidOffset)
             {
+                std::unique_lock allocLock(m_allocMutex);
                 offset = m_tweakDb->CreateFlatValue(*value);
-                pool.emplace(hash, offset);
+
+                std::unique_lock poolLockRW(pool.mutex);
+                pool.values.emplace(hash, offset);
             }
 
             m_defaults.emplace(typeName, offset);
 
-            ResolveOffset(static_cast<int32_t>(offset));
+            const auto data = ResolveOffset(static_cast<int32_t>(offset));
+            const auto fixedIndex = GetFixedIndex(typeName.hash);
+
+            // The defaults are resolved before any value is assigned,
+            // so the fixed types info is always ready for the fast path.
+            if (fixedIndex < m_fixedTypes.size())
+            {
+                const auto addr = reinterpret_cast<uintptr_t>(m_tweakDb->flatDataBuffer + offset);
+
+                m_fixedTypes[fixedIndex].vft = *reinterpret_cast<uintptr_t*>(addr);
+                m_fixedTypes[fixedIndex].offset = reinterpret_cast<uintptr_t>(data.instance) - addr;
+                m_fixedTypes[fixedIndex].pool = m_pools.at(typeName).get();
+            }
         }
     }
 }
 
+template<typename F>
+void Red::TweakDBBuffer::ForEachValue(uintptr_t aOffsetStart, uintptr_t aOffsetEnd, F&& aCallback)
+{
+    auto offset = Red::AlignUp(static_cast<uint32_t>(aOffsetStart), FlatAlignment);
+    while (offset < aOffsetEnd)
+    {
+        auto padding = 0u;
+
+        // The current offset should always point to the VFT of the next flat.
+        // If there's zero instead, that means the next value is 16-byte aligned,
+        // and we need to skip the 8-byte padding to get to the flat.
+        if (*reinterpret_cast<uint64_t*>(m_tweakDb->flatDataBuffer + offset) == 0ull)
+        {
+            offset += 8u;
+            padding = 8u;
+        }
+
+        const auto data = ResolveOffset(static_cast<int32_t>(offset));
+
+        // Step {vft + data_size} aligned by {max(data_align, 8)}
+        const auto size = Red::AlignUp(FlatVFTSize + data.type->GetSize(),
+                                       std::max(FlatAlignment, data.type->GetAlignment()));
+
+        aCallback(offset, data, size, padding);
+
+        offset += size;
+    }
+}
+
 void Red::TweakDBBuffer::SyncBufferData()
 {
-    std::unique_lock poolLockRW(m_poolMutex);
+    std::unique_lock syncLock(m_syncMutex);
+
+    // Values are only scanned up to this point, the ones created after
+    // will be picked up by the next sync.
+    uintptr_t offsetEnd;
+    {
+        std::unique_lock allocLock(m_allocMutex);
+        offsetEnd = m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+    }
 
-    auto offsetEnd = m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+    if (m_validateCheckpoint)
+        ValidateCheckpoint(offsetEnd);
 
     if (m_offsetEnd == offsetEnd)
     {
-        SyncBufferBounds();
+        SyncBufferBounds(offsetEnd);
         return;
     }
 
@@ -263,29 +484,19 @@ void Red::TweakDBBuffer::SyncBufferData()
     {
         std::shared_lock flatLockR(m_tweakDb->mutex00);
 
-        auto offset = Red::AlignUp(static_cast<uint32_t>(m_offsetEnd), FlatAlignment);
-        while (offset < offsetEnd)
-        {
-            // The current offset should always point to the VFT of the next flat.
-            // If there's zero instead, that means the next value is 16-byte aligned,
-            // and we need to skip the 8-byte padding to get to the flat.
-            if (*reinterpret_cast<uint64_t*>(m_tweakDb->flatDataBuffer + offset) == 0ull)
-                 offset += 8u;
-
-            const auto data = ResolveOffset(static_cast<int32_t>(offset));
-            const auto hash = ComputeHash(data.type, data.instance);
+        ForEachValue(m_offsetEnd, offsetEnd, [&](uint32_t aOffset, const Red::Value<>& aData, uint32_t, uint32_t) {
+            const auto hash = ComputeHash(aData.type, aData.instance);
 
-            auto& pool = m_pools.at(data.type->GetName());
+            auto& pool = *m_pools.at(aData.type->GetName());
 
             // Check for duplicates...
             // (Original game's blob has ~24K duplicates)
-            if (!pool.contains(hash))
-                pool.emplace(hash, offset);
-
-            // Step {vft + data_size} aligned by {max(data_align, 8)}
-            offset += Red::AlignUp(FlatVFTSize + data.type->GetSize(),
-                                   std::max(FlatAlignment, data.type->GetAlignment()));
-        }
+            {
+                std::unique_lock poolLockRW(pool.mutex);
+                if (!pool.values.contains(hash))
+                    pool.values.emplace(hash, aOffset);
+            }
+        });
     }
 
     const auto endTimePoint = std::chrono::steady_clock::now();
@@ -294,15 +505,232 @@ void Red::TweakDBBuffer::SyncBufferData()
     if (m_offsetEnd == 0)
         FillDefaults();
 
-    SyncBufferBounds();
+    SyncBufferBounds(offsetEnd);
 
     UpdateStats(updateTime);
 }
 
-void Red::TweakDBBuffer::SyncBufferBounds()
+void Red::TweakDBBuffer::SaveCheckpoint()
+{
+    std::unique_lock syncLock(m_syncMutex);
+
+    // The buffer can't be checked while an invalidation is pending, and there's nothing to keep before the scan
+    if (m_validateCheckpoint || m_offsetEnd == 0)
+        return;
+
+    const uintptr_t offsetEnd = m_offsetEnd;
+
+    m_checkpoint.buffer = reinterpret_cast<uintptr_t>(m_tweakDb->flatDataBuffer);
+    m_checkpoint.offsetEnd = offsetEnd;
+    m_checkpoint.fingerprint = ComputeFingerprint(offsetEnd);
+}
+
+void Red::TweakDBBuffer::SyncBufferBounds(uintptr_t aOffsetEnd)
+{
+    m_offsetEnd = aOffsetEnd;
+    m_bufferEnd = m_tweakDb->flatDataBuffer + aOffsetEnd;
+}
+
+void Red::TweakDBBuffer::ValidateCheckpoint(uintptr_t aOffsetEnd)
+{
+    m_validateCheckpoint = false;
+
+    // Values are never modified once created and only compaction moves them, which drops the checkpoint,
+    // so as long as the scanned region is intact, only the values appended after it have to be scanned.
+    const auto isIntact = m_checkpoint.offsetEnd != 0 &&
+                          m_checkpoint.buffer == reinterpret_cast<uintptr_t>(m_tweakDb->flatDataBuffer) &&
+                          m_checkpoint.offsetEnd <= aOffsetEnd &&
+                          m_checkpoint.fingerprint == ComputeFingerprint(m_checkpoint.offsetEnd);
+
+    if (isIntact)
+    {
+        m_offsetEnd = m_checkpoint.offsetEnd;
+        return;
+    }
+
+    // The game replaced the blob, everything has to be scanned again.
+    ResetPools();
+}
+
+void Red::TweakDBBuffer::ResetPools()
 {
-    m_bufferEnd = m_tweakDb->flatDataBufferEnd;
-    m_offsetEnd = m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+    m_offsetEnd = 0;
+    m_checkpoint = {};
+
+    for (const auto& [_, pool] : m_pools)
+    {
+        std::unique_lock poolLockRW(pool->mutex);
+        pool->values.clear();
+    }
+
+    m_defaults.clear();
+
+    m_stats = {};
+    m_readContentions = 0;
+    m_writeContentions = 0;
+}
+
+Core::Set<int32_t> Red::TweakDBBuffer::CollectReferences()
+{
+    Core::Set<int32_t> references;
+    references.reserve(m_tweakDb->flats.size);
+
+    for (const auto* flat = m_tweakDb->flats.Begin(); flat != m_tweakDb->flats.End(); ++flat)
+    {
+        references.insert(flat->ToTDBOffset());
+    }
+
+    return references;
+}
+
+Red::TweakDBBuffer::BufferUsage Red::TweakDBBuffer::AnalyzeUsage()
+{
+    if (IsBufferChanged())
+        SyncBufferData();
+
+    std::unique_lock syncLock(m_syncMutex);
+
+    uintptr_t offsetEnd;
+    {
+        std::unique_lock allocLock(m_allocMutex);
+        offsetEnd = m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer;
+    }
+
+    BufferUsage usage;
+    Core::Map<Red::CName, size_t> typeIndexes;
+
+    std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+    const auto references = CollectReferences();
+
+    ForEachValue(0, offsetEnd, [&](uint32_t aOffset, const Red::Value<>& aData, uint32_t aSize, uint32_t aPadding) {
+        const auto typeName = aData.type->GetName();
+
+        auto typeIndex = typeIndexes.find(typeName);
+        if (typeIndex == typeIndexes.end())
+        {
+            typeIndex = typeIndexes.emplace(typeName, usage.types.size()).first;
+            usage.types.push_back({typeName});
+        }
+
+        auto& typeUsage = usage.types[typeIndex->second];
+        const auto bytes = aSize + aPadding;
+
+        ++typeUsage.values;
+        typeUsage.bytes += bytes;
+
+        if (!references.contains(static_cast<int32_t>(aOffset)))
+        {
+            ++typeUsage.deadValues;
+            typeUsage.deadBytes += bytes;
+        }
+    });
+
+    for (const auto& typeUsage : usage.types)
+    {
+        usage.values += typeUsage.values;
+        usage.deadValues += typeUsage.deadValues;
+        usage.bytes += typeUsage.bytes;
+        usage.deadBytes += typeUsage.deadBytes;
+    }
+
+    return usage;
+}
+
+std::optional<size_t> Red::TweakDBBuffer::Compact()
+{
+    if (IsBufferChanged())
+        SyncBufferData();
+
+    std::unique_lock syncLock(m_syncMutex);
+    std::unique_lock allocLock(m_allocMutex);
+    std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+    const auto offsetEnd = static_cast<uintptr_t>(m_tweakDb->flatDataBufferEnd - m_tweakDb->flatDataBuffer);
+    const auto references = CollectReferences();
+
+    struct ValueMove
+    {
+        uint32_t offset;
+        uint32_t targetOffset;
+        uint32_t size;
+    };
+
+    Core::Vector<ValueMove> moves;
+    moves.reserve(references.size());
+
+    Core::Map<int32_t, int32_t> relocations;
+    relocations.reserve(references.size());
+
+    // The moves are planned before anything is changed, so the buffer can be left as is when they don't add up
+    uint32_t writeOffset = 0;
+
+    ForEachValue(0, offsetEnd, [&](uint32_t aOffset, const Red::Value<>& aData, uint32_t aSize, uint32_t) {
+        if (!references.contains(static_cast<int32_t>(aOffset)))
+            return;
+
+        writeOffset = Red::AlignUp(writeOffset, std::max(FlatAlignment, aData.type->GetAlignment()));
+
+        moves.push_back({aOffset, writeOffset, aSize});
+        relocations.emplace(static_cast<int32_t>(aOffset), static_cast<int32_t>(writeOffset));
+
+        writeOffset += aSize;
+    });
+
+    // A flat that doesn't point to the start of a value can't be relocated
+    for (const auto* flat = m_tweakDb->flats.Begin(); flat != m_tweakDb->flats.End(); ++flat)
+    {
+        if (!relocations.contains(flat->ToTDBOffset()))
+            return {};
+    }
+
+    // Values only move towards the start of the buffer, so every value is read before it can be overwritten.
+    // The unreferenced values are not destructed, the game or scripts may still share their external data,
+    // only their space in the buffer is reused.
+    auto* buffer = reinterpret_cast<uint8_t*>(m_tweakDb->flatDataBuffer);
+    uint32_t paddingOffset = 0;
+
+    for (const auto& move : moves)
+    {
+        // Zero padding is how the scan recognizes 16-byte aligned values
+        if (paddingOffset != move.targetOffset)
+        {
+            std::memset(buffer + paddingOffset, 0, move.targetOffset - paddingOffset);
+        }
+
+        if (move.offset != move.targetOffset)
+        {
+            std::memmove(buffer + move.targetOffset, buffer + move.offset, move.size);
+        }
+
+        paddingOffset = move.targetOffset + move.size;
+    }
+
+    for (auto* flat = m_tweakDb->flats.Begin(); flat != m_tweakDb->flats.End(); ++flat)
+    {
+        flat->SetTDBOffset(relocations.find(flat->ToTDBOffset())->second);
+    }
+
+    std::memset(buffer + writeOffset, 0, offsetEnd - writeOffset);
+    m_tweakDb->flatDataBufferEnd = m_tweakDb->flatDataBuffer + writeOffset;
+
+    // All pooled offsets are stale now, the next access scans the compacted buffer
+    ResetPools();
+    m_bufferEnd = 0;
+    m_validateCheckpoint = false;
+
+    return offsetEnd - writeOffset;
+}
+
+uint64_t Red::TweakDBBuffer::ComputeFingerprint(uintptr_t aOffsetEnd) const
+{
+    // The whole region is hashed, since a replaced blob can match any sampled part of the previous one.
+    // It only runs for checkpoints and their validation, not for every sync.
+    const auto* data = reinterpret_cast<const uint8_t*>(m_tweakDb->flatDataBuffer);
+
+    const auto hash = m_hasher(reinterpret_cast<const uint8_t*>(&aOffsetEnd), sizeof(aOffsetEnd), 0);
+
+    return m_hasher(data, aOffsetEnd, hash);
 }
 
 void Red::TweakDBBuffer::UpdateStats(float updateTime)
@@ -316,39 +744,45 @@ void Red::TweakDBBuffer::UpdateStats(float updateTime)
     }
 
     size_t totalValues = 0;
-    for (const auto& pool : m_pools)
-        totalValues += pool.second.size();
+    for (const auto& [_, pool] : m_pools)
+    {
+        std::shared_lock poolLockR(pool->mutex);
+        totalValues += pool->values.size();
+    }
 
     m_stats.poolSize = m_offsetEnd;
     m_stats.poolValues = totalValues;
-    m_stats.knownTypes = m_types.size();
+    {
+        std::shared_lock typeLockR(m_typeMutex);
+        m_stats.knownTypes = m_types.size();
+    }
     m_stats.flatEntries = m_tweakDb->flats.size;
 
 #ifdef VERBOSE
     Red::Log::Debug(
-        "[Red::TweakDBFlatPool] init {:.3f}s | update {:.6f}s | {} KiB | {} values | {} flats | {} types",
+        "[Red::TweakDBFlatPool] init {:.3f}s | update {:.6f}s | {} KiB | {} values | {} flats | {} types | "
+        "{} / {} contentions",
         m_stats.initTime, m_stats.updateTime,
         m_stats.poolSize / 1024, m_stats.poolValues,
-        m_stats.flatEntries, m_stats.knownTypes);
+        m_stats.flatEntries, m_stats.knownTypes,
+        m_readContentions.load(), m_writeContentions.load());
 #endif
 }
 
 Red::TweakDBBuffer::BufferStats Red::TweakDBBuffer::GetStats() const
 {
-    return m_stats;
+    auto stats = m_stats;
+    stats.readContentions = m_readContentions;
+    stats.writeContentions = m_writeContentions;
+
+    return stats;
 }
 
 void Red::TweakDBBuffer::Invalidate()
 {
-    std::unique_lock poolLockRW(m_poolMutex);
+    std::unique_lock syncLock(m_syncMutex);
 
+    // The pools are kept until the next sync confirms the buffer was replaced.
     m_bufferEnd = 0;
-    m_offsetEnd = 0;
-
-    for (const auto& typeName : s_flatTypes)
-    {
-        m_pools.at(typeName).clear();
-    }
-
-    m_stats = {};
+    m_validateCheckpoint = true;
 }
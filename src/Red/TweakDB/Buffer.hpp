@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Red/TweakDB/Alias.hpp"
+#include "Red/TweakDB/Hasher.hpp"
 
 namespace Red
 {
@@ -8,6 +9,7 @@ class TweakDBBuffer
 {
 public:
     static constexpr int32_t InvalidOffset = -1;
+    static constexpr uint64_t HashSeed = 0xCBF29CE484222325;
 
     struct BufferStats
     {
@@ -17,15 +19,41 @@ public:
         size_t poolValues = 0;
         size_t knownTypes = 0;
         size_t flatEntries = 0;
+        size_t readContentions = 0; // lookups that had to wait for a writer
+        size_t writeContentions = 0; // insertions that had to wait for another thread
+    };
+
+    struct TypeUsage
+    {
+        Red::CName type;
+        size_t values = 0;
+        size_t deadValues = 0; // values not referenced by any flat
+        size_t bytes = 0;
+        size_t deadBytes = 0;
+    };
+
+    struct BufferUsage
+    {
+        Core::Vector<TypeUsage> types;
+        size_t values = 0;
+        size_t deadValues = 0;
+        size_t bytes = 0;
+        size_t deadBytes = 0;
     };
 
     TweakDBBuffer();
     explicit TweakDBBuffer(Red::TweakDB* aTweakDb);
+    TweakDBBuffer(Red::TweakDB* aTweakDb, Red::TweakDBHasher::Function aHasher);
 
     int32_t AllocateValue(const Red::Value<>& aData);
     int32_t AllocateValue(const Red::CBaseRTTIType* aType, Red::Instance aInstance);
     int32_t AllocateDefault(const Red::CBaseRTTIType* aType);
 
+    // Returns the offset of the value for a flat that currently points to the given offset.
+    // If the current value is equal, the same offset is returned, if it has a different type,
+    // the result is InvalidOffset.
+    int32_t AssignValue(int32_t aOffset, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
+
     Red::Value<> GetValue(int32_t aOffset);
     Red::Instance GetValuePtr(int32_t aOffset);
     uint64_t GetValueHash(int32_t aOffset);
@@ -34,8 +62,22 @@ public:
 
     void Invalidate();
 
-    inline static uint64_t ComputeHash(const Red::CBaseRTTIType* aType, Red::Instance aInstance,
-                                       uint64_t aSeed = 0xCBF29CE484222325);
+    // Fingerprints the scanned values, so that the next sync after Invalidate() can keep the pools
+    // if the game didn't replace them. Values scanned after the checkpoint are scanned again.
+    void SaveCheckpoint();
+
+    // Marks the values referenced by flats and counts the unreferenced ones per type.
+    BufferUsage AnalyzeUsage();
+
+    // Moves the referenced values to the start of the buffer and rewrites the flat offsets.
+    // Any other offsets and value pointers are invalidated, so it must only be called at a point
+    // where nothing else holds them, the manager only compacts when no batch or commit is in flight.
+    // Returns the number of released bytes, or nothing if a flat points outside of the known values,
+    // the buffer is left untouched then.
+    std::optional<size_t> Compact();
+
+    inline uint64_t ComputeHash(const Red::CBaseRTTIType* aType, Red::Instance aInstance,
+                                uint64_t aSeed = HashSeed) const;
 
 private:
     struct FlatTypeInfo
@@ -45,25 +87,77 @@ private:
     };
 
     using FlatValueMap = Core::Map<uint64_t, int32_t>; // ValueHash -> BufferOffset
-    using FlatPoolMap = Core::Map<Red::CName, FlatValueMap>; // TypeName -> FlatPool
+
+    // Each flat type has its own pool, so lookups only wait for insertions of the same type.
+    // The values themselves are created by the game one at a time, so insertions of all types are serialized.
+    struct FlatPool
+    {
+        FlatValueMap values;
+        std::shared_mutex mutex;
+    };
+
+    // Flat types that have a fixed size and no external data,
+    // so their values can be compared and hashed as plain bytes without RTTI calls.
+    static constexpr size_t FixedTypeCount = 10;
+
+    struct FixedTypeInfo
+    {
+        uintptr_t vft;
+        uintptr_t offset;
+        FlatPool* pool;
+    };
+
+    using FlatPoolMap = Core::Map<Red::CName, Core::UniquePtr<FlatPool>>; // TypeName -> FlatPool
     using FlatDefaultMap = Core::Map<Red::CName, int32_t>; // TypeName -> BufferOffset
     using FlatTypeMap = Core::Map<uintptr_t, FlatTypeInfo>; // VFT -> FlatTypeInfo
 
+    // State of the scan at the last saved checkpoint.
+    // The pools are only valid for the buffer that produced the same fingerprint.
+    struct ScanCheckpoint
+    {
+        uintptr_t buffer;
+        uintptr_t offsetEnd;
+        uint64_t fingerprint;
+    };
+
     inline Red::Value<> ResolveOffset(int32_t aOffset);
+    inline bool IsBufferChanged() const;
+
+    int32_t FindValue(FlatPool& aPool, uint64_t aHash);
+    int32_t InsertValue(FlatPool& aPool, uint64_t aHash, const Red::CBaseRTTIType* aType,
+                        Red::Instance aInstance);
+
+    template<typename T, size_t AIndex>
+    int32_t AssignFixedValue(int32_t aOffset, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
+
+    template<typename F>
+    void ForEachValue(uintptr_t aOffsetStart, uintptr_t aOffsetEnd, F&& aCallback);
+    Core::Set<int32_t> CollectReferences();
 
     void CreatePools();
     void FillDefaults();
     void SyncBufferData();
-    void SyncBufferBounds();
+    void SyncBufferBounds(uintptr_t aOffsetEnd);
+    void ValidateCheckpoint(uintptr_t aOffsetEnd);
+    void ResetPools();
+    uint64_t ComputeFingerprint(uintptr_t aOffsetEnd) const;
     void UpdateStats(float updateTime = 0);
 
     Red::TweakDB* m_tweakDb;
+    Red::TweakDBHasher::Function m_hasher;
     FlatPoolMap m_pools;
     FlatDefaultMap m_defaults;
     FlatTypeMap m_types;
-    uintptr_t m_bufferEnd;
-    uintptr_t m_offsetEnd;
+    std::array<FixedTypeInfo, FixedTypeCount> m_fixedTypes;
+    std::atomic<uintptr_t> m_bufferEnd;
+    std::atomic<uintptr_t> m_offsetEnd;
+    ScanCheckpoint m_checkpoint;
+    bool m_validateCheckpoint;
     BufferStats m_stats;
-    std::shared_mutex m_poolMutex;
+    std::atomic<size_t> m_readContentions;
+    std::atomic<size_t> m_writeContentions;
+    std::mutex m_syncMutex;
+    std::mutex m_allocMutex;
+    std::shared_mutex m_typeMutex;
 };
 }
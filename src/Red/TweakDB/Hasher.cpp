@@ -0,0 +1,409 @@
+#include "Hasher.hpp"
+
+#include <immintrin.h>
+#include <intrin.h>
+
+namespace
+{
+constexpr uint64_t Prime0 = 0xA0761D6478BD642F;
+constexpr uint64_t Prime1 = 0xE7037ED1A0B428DB;
+constexpr uint64_t Prime2 = 0x8EBC6AF09C88C6E3;
+constexpr uint64_t Prime3 = 0x589965CC75374CC3;
+constexpr uint32_t ScramblePrime = 0x9E3779B1;
+
+constexpr auto StripeSize = 64u;
+constexpr auto StripeLanes = 8u;
+constexpr auto StripesPerBlock = 16u;
+constexpr auto BlockSize = StripeSize * StripesPerBlock;
+constexpr auto LongInputSize = 256u;
+
+// Every stripe of a block uses keys shifted by one lane,
+// so that reordered stripes don't produce the same accumulators.
+constexpr auto SecretSize = StripesPerBlock + StripeLanes;
+constexpr auto ScrambleKey = StripesPerBlock;
+constexpr auto LastStripeKey = StripesPerBlock - 1;
+
+constexpr std::array<uint64_t, SecretSize> MakeSecret()
+{
+    std::array<uint64_t, SecretSize> secret{};
+    uint64_t state = Prime0;
+
+    for (auto& key : secret)
+    {
+        // SplitMix64
+        state += 0x9E3779B97F4A7C15;
+        auto value = state;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+        key = value ^ (value >> 31);
+    }
+
+    return secret;
+}
+
+constexpr auto s_secret = MakeSecret();
+
+inline uint64_t Read64(const uint8_t* aData)
+{
+    uint64_t value;
+    std::memcpy(&value, aData, sizeof(value));
+    return value;
+}
+
+inline uint64_t Read32(const uint8_t* aData)
+{
+    uint32_t value;
+    std::memcpy(&value, aData, sizeof(value));
+    return value;
+}
+
+inline uint64_t Read3(const uint8_t* aData, size_t aSize)
+{
+    return (static_cast<uint64_t>(aData[0]) << 16) | (static_cast<uint64_t>(aData[aSize >> 1]) << 8) |
+           aData[aSize - 1];
+}
+
+inline void Multiply(uint64_t& aLeft, uint64_t& aRight)
+{
+    uint64_t high;
+    aLeft = _umul128(aLeft, aRight, &high);
+    aRight = high;
+}
+
+inline uint64_t Mix(uint64_t aLeft, uint64_t aRight)
+{
+    Multiply(aLeft, aRight);
+    return aLeft ^ aRight;
+}
+
+inline uint64_t Avalanche(uint64_t aHash)
+{
+    aHash ^= aHash >> 37;
+    aHash *= 0x165667919E3779F9;
+    aHash ^= aHash >> 32;
+    return aHash;
+}
+
+struct ScalarAccumulator
+{
+    static void Process(uint64_t* aAcc, const uint8_t* aData, size_t aStripes, const uint64_t* aKey)
+    {
+        for (size_t s = 0; s < aStripes; ++s)
+        {
+            Stripe(aAcc, aData + s * StripeSize, aKey + s);
+        }
+    }
+
+    static void Stripe(uint64_t* aAcc, const uint8_t* aData, const uint64_t* aKey)
+    {
+        for (auto i = 0u; i < StripeLanes; ++i)
+        {
+            const auto dataValue = Read64(aData + i * sizeof(uint64_t));
+            const auto dataKey = dataValue ^ aKey[i];
+
+            aAcc[i ^ 1] += dataValue;
+            aAcc[i] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+        }
+    }
+
+    static void Scramble(uint64_t* aAcc, const uint64_t* aKey)
+    {
+        for (auto i = 0u; i < StripeLanes; ++i)
+        {
+            auto acc = aAcc[i];
+            acc ^= acc >> 47;
+            acc ^= aKey[i];
+            acc *= ScramblePrime;
+            aAcc[i] = acc;
+        }
+    }
+};
+
+struct SSE2Accumulator
+{
+    static void Process(uint64_t* aAcc, const uint8_t* aData, size_t aStripes, const uint64_t* aKey)
+    {
+        for (size_t s = 0; s < aStripes; ++s)
+        {
+            Stripe(aAcc, aData + s * StripeSize, aKey + s);
+        }
+    }
+
+    static void Stripe(uint64_t* aAcc, const uint8_t* aData, const uint64_t* aKey)
+    {
+        auto* acc = reinterpret_cast<__m128i*>(aAcc);
+        const auto* data = reinterpret_cast<const __m128i*>(aData);
+        const auto* key = reinterpret_cast<const __m128i*>(aKey);
+
+        for (auto i = 0u; i < StripeLanes / 2; ++i)
+        {
+            const auto dataValue = _mm_loadu_si128(data + i);
+            const auto dataKey = _mm_xor_si128(dataValue, _mm_loadu_si128(key + i));
+            const auto dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+            const auto product = _mm_mul_epu32(dataKey, dataKeyHigh);
+            const auto swapped = _mm_shuffle_epi32(dataValue, _MM_SHUFFLE(1, 0, 3, 2));
+
+            auto value = _mm_loadu_si128(acc + i);
+            value = _mm_add_epi64(value, _mm_add_epi64(product, swapped));
+            _mm_storeu_si128(acc + i, value);
+        }
+    }
+
+    static void Scramble(uint64_t* aAcc, const uint64_t* aKey)
+    {
+        auto* acc = reinterpret_cast<__m128i*>(aAcc);
+        const auto* key = reinterpret_cast<const __m128i*>(aKey);
+        const auto prime = _mm_set1_epi32(static_cast<int>(ScramblePrime));
+
+        for (auto i = 0u; i < StripeLanes / 2; ++i)
+        {
+            auto value = _mm_loadu_si128(acc + i);
+            value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+            value = _mm_xor_si128(value, _mm_loadu_si128(key + i));
+
+            const auto low = _mm_mul_epu32(value, prime);
+            const auto high = _mm_mul_epu32(_mm_srli_epi64(value, 32), prime);
+            _mm_storeu_si128(acc + i, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+        }
+    }
+};
+
+struct AVX2Accumulator
+{
+    static void Process(uint64_t* aAcc, const uint8_t* aData, size_t aStripes, const uint64_t* aKey)
+    {
+        for (size_t s = 0; s < aStripes; ++s)
+        {
+            Stripe(aAcc, aData + s * StripeSize, aKey + s);
+        }
+    }
+
+    static void Stripe(uint64_t* aAcc, const uint8_t* aData, const uint64_t* aKey)
+    {
+        auto* acc = reinterpret_cast<__m256i*>(aAcc);
+        const auto* data = reinterpret_cast<const __m256i*>(aData);
+        const auto* key = reinterpret_cast<const __m256i*>(aKey);
+
+        for (auto i = 0u; i < StripeLanes / 4; ++i)
+        {
+            const auto dataValue = _mm256_loadu_si256(data + i);
+            const auto dataKey = _mm256_xor_si256(dataValue, _mm256_loadu_si256(key + i));
+            const auto dataKeyHigh = _mm256_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+            const auto product = _mm256_mul_epu32(dataKey, dataKeyHigh);
+            const auto swapped = _mm256_shuffle_epi32(dataValue, _MM_SHUFFLE(1, 0, 3, 2));
+
+            auto value = _mm256_loadu_si256(acc + i);
+            value = _mm256_add_epi64(value, _mm256_add_epi64(product, swapped));
+            _mm256_storeu_si256(acc + i, value);
+        }
+    }
+
+    static void Scramble(uint64_t* aAcc, const uint64_t* aKey)
+    {
+        auto* acc = reinterpret_cast<__m256i*>(aAcc);
+        const auto* key = reinterpret_cast<const __m256i*>(aKey);
+        const auto prime = _mm256_set1_epi32(static_cast<int>(ScramblePrime));
+
+        for (auto i = 0u; i < StripeLanes / 4; ++i)
+        {
+            auto value = _mm256_loadu_si256(acc + i);
+            value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+            value = _mm256_xor_si256(value, _mm256_loadu_si256(key + i));
+
+            const auto low = _mm256_mul_epu32(value, prime);
+            const auto high = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), prime);
+            _mm256_storeu_si256(acc + i, _mm256_add_epi64(low, _mm256_slli_epi64(high, 32)));
+        }
+    }
+};
+
+template<class Accumulator>
+uint64_t HashLong(const uint8_t* aData, size_t aSize, uint64_t aSeed)
+{
+    alignas(32) uint64_t acc[StripeLanes];
+
+    for (auto i = 0u; i < StripeLanes; ++i)
+    {
+        acc[i] = s_secret[i] ^ aSeed;
+    }
+
+    const auto blocks = (aSize - 1) / BlockSize;
+
+    for (size_t b = 0; b < blocks; ++b)
+    {
+        Accumulator::Process(acc, aData + b * BlockSize, StripesPerBlock, s_secret.data());
+        Accumulator::Scramble(acc, s_secret.data() + ScrambleKey);
+    }
+
+    // The last stripe always ends at the end of the input, overlapping with the previous one if needed
+    const auto stripes = ((aSize - 1) - blocks * BlockSize) / StripeSize;
+    Accumulator::Process(acc, aData + blocks * BlockSize, stripes, s_secret.data());
+    Accumulator::Stripe(acc, aData + aSize - StripeSize, s_secret.data() + LastStripeKey);
+
+    auto hash = aSize * Prime0;
+    for (auto i = 0u; i < StripeLanes; i += 2)
+    {
+        hash += Mix(acc[i] ^ s_secret[i + 1], acc[i + 1] ^ s_secret[i + 2]);
+    }
+
+    return Avalanche(hash ^ aSeed);
+}
+
+// Inputs up to the long threshold are hashed the same way by all implementations,
+// vector registers only pay off when there are several stripes to process.
+template<class Accumulator>
+uint64_t Hash(const uint8_t* aData, size_t aSize, uint64_t aSeed)
+{
+    if (aSize > LongInputSize)
+        return HashLong<Accumulator>(aData, aSize, aSeed);
+
+    aSeed ^= Mix(aSeed ^ Prime0, Prime1);
+
+    uint64_t a;
+    uint64_t b;
+
+    if (aSize <= 16)
+    {
+        if (aSize >= 4)
+        {
+            const auto shift = (aSize >> 3) << 2;
+            a = (Read32(aData) << 32) | Read32(aData + shift);
+            b = (Read32(aData + aSize - 4) << 32) | Read32(aData + aSize - 4 - shift);
+        }
+        else if (aSize > 0)
+        {
+            a = Read3(aData, aSize);
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        const auto* data = aData;
+        auto remaining = aSize;
+
+        if (remaining > 48)
+        {
+            auto seed1 = aSeed;
+            auto seed2 = aSeed;
+
+            do
+            {
+                aSeed = Mix(Read64(data) ^ Prime1, Read64(data + 8) ^ aSeed);
+                seed1 = Mix(Read64(data + 16) ^ Prime2, Read64(data + 24) ^ seed1);
+                seed2 = Mix(Read64(data + 32) ^ Prime3, Read64(data + 40) ^ seed2);
+                data += 48;
+                remaining -= 48;
+            } while (remaining > 48);
+
+            aSeed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            aSeed = Mix(Read64(data) ^ Prime1, Read64(data + 8) ^ aSeed);
+            data += 16;
+            remaining -= 16;
+        }
+
+        a = Read64(data + remaining - 16);
+        b = Read64(data + remaining - 8);
+    }
+
+    a ^= Prime1;
+    b ^= aSeed;
+    Multiply(a, b);
+
+    return Mix(a ^ Prime0 ^ aSize, b ^ Prime1);
+}
+
+uint64_t HashFNV1a(const uint8_t* aData, size_t aSize, uint64_t aSeed)
+{
+    return Red::FNV1a64(aData, aSize, aSeed);
+}
+
+bool IsAVX2Supported()
+{
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // The OS must save the YMM registers
+    __cpuid(info, 1);
+    const auto hasOSXSAVE = (info[2] & (1 << 27)) != 0;
+    const auto hasAVX = (info[2] & (1 << 28)) != 0;
+
+    if (!hasOSXSAVE || !hasAVX || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+}
+}
+
+Red::TweakDBHasher::Function Red::TweakDBHasher::Get()
+{
+    static const auto s_function = Get(GetBest());
+    return s_function;
+}
+
+Red::TweakDBHasher::Function Red::TweakDBHasher::Get(Implementation aImplementation)
+{
+    switch (aImplementation)
+    {
+    case Implementation::FNV1a:
+        return &HashFNV1a;
+    case Implementation::Scalar:
+        return &Hash<ScalarAccumulator>;
+    case Implementation::SSE2:
+        return &Hash<SSE2Accumulator>;
+    case Implementation::AVX2:
+        return &Hash<AVX2Accumulator>;
+    }
+
+    return &Hash<ScalarAccumulator>;
+}
+
+Red::TweakDBHasher::Implementation Red::TweakDBHasher::GetBest()
+{
+    static const auto s_best = IsSupported(Implementation::AVX2) ? Implementation::AVX2 : Implementation::SSE2;
+    return s_best;
+}
+
+bool Red::TweakDBHasher::IsSupported(Implementation aImplementation)
+{
+    switch (aImplementation)
+    {
+    case Implementation::AVX2:
+    {
+        static const auto s_supported = IsAVX2Supported();
+        return s_supported;
+    }
+    default:
+        // SSE2 is part of the x64 baseline
+        return true;
+    }
+}
+
+const char* Red::TweakDBHasher::GetName(Implementation aImplementation)
+{
+    switch (aImplementation)
+    {
+    case Implementation::FNV1a:
+        return "FNV1a";
+    case Implementation::Scalar:
+        return "Scalar";
+    case Implementation::SSE2:
+        return "SSE2";
+    case Implementation::AVX2:
+        return "AVX2";
+    }
+
+    return "Unknown";
+}
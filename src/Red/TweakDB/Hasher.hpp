@@ -0,0 +1,31 @@
+#pragma once
+
+namespace Red
+{
+// Fast non-cryptographic 64-bit hash for flat values.
+//
+// Short inputs are mixed with 128-bit multiplications, long inputs are processed in 64-byte stripes
+// by eight independent accumulators, which maps directly to SSE2 and AVX2 registers.
+// All implementations except FNV1a produce identical results, the fastest one supported by the CPU
+// is selected once. FNV1a is the previous hash, kept as a reference for benchmarks.
+class TweakDBHasher
+{
+public:
+    enum class Implementation
+    {
+        FNV1a,
+        Scalar,
+        SSE2,
+        AVX2,
+    };
+
+    using Function = uint64_t (*)(const uint8_t* aData, size_t aSize, uint64_t aSeed);
+
+    static Function Get();
+    static Function Get(Implementation aImplementation);
+
+    static Implementation GetBest();
+    static bool IsSupported(Implementation aImplementation);
+    static const char* GetName(Implementation aImplementation);
+};
+}
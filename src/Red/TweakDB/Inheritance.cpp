@@ -0,0 +1,265 @@
+#include "Inheritance.hpp"
+
+namespace
+{
+bool CompareIds(Red::TweakDBID aLeft, Red::TweakDBID aRight)
+{
+    return aLeft.value < aRight.value;
+}
+}
+
+Red::TweakDBInheritance::TweakDBInheritance()
+    : m_parents(nullptr)
+    , m_descendants(nullptr)
+    , m_records(nullptr)
+    , m_recordParents(nullptr)
+    , m_numberOfParents(0)
+    , m_numberOfDescendants(0)
+    , m_numberOfRecords(0)
+{
+}
+
+bool Red::TweakDBInheritance::Map(const std::filesystem::path& aPath)
+{
+    Reset();
+
+    m_file.reset(CreateFileW(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr));
+
+    if (!m_file)
+        return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(m_file.get(), &fileSize) || fileSize.QuadPart < sizeof(Header))
+    {
+        Reset();
+        return false;
+    }
+
+    m_mapping.reset(CreateFileMappingW(m_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+    if (!m_mapping)
+    {
+        Reset();
+        return false;
+    }
+
+    m_view.reset(static_cast<uint8_t*>(MapViewOfFile(m_mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+
+    if (!m_view || !Attach(m_view.get(), static_cast<size_t>(fileSize.QuadPart)))
+    {
+        Reset();
+        return false;
+    }
+
+    return true;
+}
+
+void Red::TweakDBInheritance::Build(const DescendantMap& aDescendants)
+{
+    Reset();
+
+    m_buffer = Serialize(aDescendants);
+
+    Attach(m_buffer.data(), m_buffer.size());
+}
+
+void Red::TweakDBInheritance::Detach()
+{
+    if (!m_view)
+        return;
+
+    const auto size = sizeof(Header) + m_numberOfParents * sizeof(ParentEntry) +
+                      (m_numberOfDescendants + m_numberOfRecords) * sizeof(Red::TweakDBID) +
+                      m_numberOfRecords * sizeof(uint32_t);
+
+    m_buffer.assign(m_view.get(), m_view.get() + size);
+
+    Attach(m_buffer.data(), m_buffer.size());
+
+    m_view.reset();
+    m_mapping.reset();
+    m_file.reset();
+}
+
+bool Red::TweakDBInheritance::Attach(const uint8_t* aData, size_t aSize)
+{
+    if (aSize < sizeof(Header))
+        return false;
+
+    const auto* header = reinterpret_cast<const Header*>(aData);
+
+    if (header->magic != Magic || header->version != Version)
+        return false;
+
+    const auto parentsOffset = sizeof(Header);
+    const auto descendantsOffset = parentsOffset + header->numberOfParents * sizeof(ParentEntry);
+    const auto recordsOffset = descendantsOffset + header->numberOfDescendants * sizeof(Red::TweakDBID);
+    const auto recordParentsOffset = recordsOffset + header->numberOfRecords * sizeof(Red::TweakDBID);
+    const auto expectedSize = recordParentsOffset + header->numberOfRecords * sizeof(uint32_t);
+
+    if (aSize != expectedSize)
+        return false;
+
+    m_parents = reinterpret_cast<const ParentEntry*>(aData + parentsOffset);
+    m_descendants = reinterpret_cast<const Red::TweakDBID*>(aData + descendantsOffset);
+    m_records = reinterpret_cast<const Red::TweakDBID*>(aData + recordsOffset);
+    m_recordParents = reinterpret_cast<const uint32_t*>(aData + recordParentsOffset);
+    m_numberOfParents = header->numberOfParents;
+    m_numberOfDescendants = header->numberOfDescendants;
+    m_numberOfRecords = header->numberOfRecords;
+
+    return true;
+}
+
+void Red::TweakDBInheritance::Reset()
+{
+    m_parents = nullptr;
+    m_descendants = nullptr;
+    m_records = nullptr;
+    m_recordParents = nullptr;
+    m_numberOfParents = 0;
+    m_numberOfDescendants = 0;
+    m_numberOfRecords = 0;
+
+    m_buffer.clear();
+    m_view.reset();
+    m_mapping.reset();
+    m_file.reset();
+}
+
+bool Red::TweakDBInheritance::IsParent(Red::TweakDBID aRecordId) const
+{
+    return FindParent(aRecordId) != nullptr;
+}
+
+bool Red::TweakDBInheritance::IsDescendant(Red::TweakDBID aRecordId) const
+{
+    return FindRecord(aRecordId) != nullptr;
+}
+
+Red::TweakDBID Red::TweakDBInheritance::GetParent(Red::TweakDBID aRecordId) const
+{
+    const auto* record = FindRecord(aRecordId);
+
+    if (!record)
+        return {};
+
+    const auto parentIndex = m_recordParents[record - m_records];
+
+    if (parentIndex >= m_numberOfParents)
+        return {};
+
+    return m_parents[parentIndex].id;
+}
+
+std::span<const Red::TweakDBID> Red::TweakDBInheritance::GetDescendants(Red::TweakDBID aParentId) const
+{
+    const auto* parent = FindParent(aParentId);
+
+    if (!parent || parent->offset > m_numberOfDescendants || parent->count > m_numberOfDescendants - parent->offset)
+        return {};
+
+    return {m_descendants + parent->offset, parent->count};
+}
+
+const Red::TweakDBInheritance::ParentEntry* Red::TweakDBInheritance::FindParent(Red::TweakDBID aParentId) const
+{
+    const auto* end = m_parents + m_numberOfParents;
+    const auto* it = std::lower_bound(m_parents, end, aParentId, [](const ParentEntry& aEntry, Red::TweakDBID aId) {
+        return CompareIds(aEntry.id, aId);
+    });
+
+    if (it == end || it->id.value != aParentId.value)
+        return nullptr;
+
+    return it;
+}
+
+const Red::TweakDBID* Red::TweakDBInheritance::FindRecord(Red::TweakDBID aRecordId) const
+{
+    const auto* end = m_records + m_numberOfRecords;
+    const auto* it = std::lower_bound(m_records, end, aRecordId, CompareIds);
+
+    if (it == end || it->value != aRecordId.value)
+        return nullptr;
+
+    return it;
+}
+
+Core::Vector<uint8_t> Red::TweakDBInheritance::Serialize(const DescendantMap& aDescendants)
+{
+    Core::Vector<Red::TweakDBID> parentIds;
+    parentIds.reserve(aDescendants.size());
+
+    for (const auto& [parentId, descendantIds] : aDescendants)
+    {
+        if (!descendantIds.empty())
+        {
+            parentIds.push_back(parentId);
+        }
+    }
+
+    std::sort(parentIds.begin(), parentIds.end(), CompareIds);
+
+    Core::Vector<ParentEntry> parents;
+    Core::Vector<Red::TweakDBID> descendants;
+    Core::Map<Red::TweakDBID, uint32_t> recordParents;
+
+    parents.reserve(parentIds.size());
+
+    for (const auto& parentId : parentIds)
+    {
+        const auto& descendantIds = aDescendants.find(parentId)->second;
+        const auto offset = static_cast<uint32_t>(descendants.size());
+        const auto parentIndex = static_cast<uint32_t>(parents.size());
+
+        descendants.insert(descendants.end(), descendantIds.begin(), descendantIds.end());
+        std::sort(descendants.begin() + offset, descendants.end(), CompareIds);
+
+        for (const auto& descendantId : descendantIds)
+        {
+            recordParents[descendantId] = parentIndex;
+        }
+
+        parents.push_back({parentId, offset, static_cast<uint32_t>(descendantIds.size())});
+    }
+
+    Core::Vector<Red::TweakDBID> records;
+    records.reserve(recordParents.size());
+
+    for (const auto& [recordId, _] : recordParents)
+    {
+        records.push_back(recordId);
+    }
+
+    std::sort(records.begin(), records.end(), CompareIds);
+
+    Header header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.numberOfParents = static_cast<uint32_t>(parents.size());
+    header.numberOfDescendants = static_cast<uint32_t>(descendants.size());
+    header.numberOfRecords = static_cast<uint32_t>(records.size());
+
+    Core::Vector<uint8_t> data;
+    data.reserve(sizeof(Header) + parents.size() * sizeof(ParentEntry) +
+                 (descendants.size() + records.size()) * sizeof(Red::TweakDBID) + records.size() * sizeof(uint32_t));
+
+    const auto write = [&data](const void* aSource, size_t aSize) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(aSource);
+        data.insert(data.end(), bytes, bytes + aSize);
+    };
+
+    write(&header, sizeof(header));
+    write(parents.data(), parents.size() * sizeof(ParentEntry));
+    write(descendants.data(), descendants.size() * sizeof(Red::TweakDBID));
+    write(records.data(), records.size() * sizeof(Red::TweakDBID));
+
+    for (const auto& recordId : records)
+    {
+        write(&recordParents[recordId], sizeof(uint32_t));
+    }
+
+    return data;
+}
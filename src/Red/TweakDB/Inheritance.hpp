@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Core/Win.hpp"
+
+namespace Red
+{
+// Read-only index of the original record inheritance.
+//
+// Binary layout (little endian, all sections are sorted by TweakDBID):
+//   Header
+//   ParentEntry[numberOfParents]         -- parent id + span in the descendant list
+//   TweakDBID[numberOfDescendants]       -- descendants grouped by parent
+//   TweakDBID[numberOfRecords]           -- every record that has a parent
+//   uint32_t[numberOfRecords]            -- index of the parent entry for each record
+//
+// The layout is queried in place, so the file can be memory mapped without any parsing.
+class TweakDBInheritance
+{
+public:
+    static constexpr uint32_t Magic = 0x4D495854; // TXIM
+    static constexpr uint32_t Version = 2;
+
+    using DescendantMap = Core::Map<Red::TweakDBID, Core::Set<Red::TweakDBID>>;
+
+    TweakDBInheritance();
+    ~TweakDBInheritance() = default;
+
+    TweakDBInheritance(const TweakDBInheritance&) = delete;
+    TweakDBInheritance& operator=(const TweakDBInheritance&) = delete;
+
+    // Maps the file in the indexed layout.
+    // Returns false if the file is in a different format or is damaged.
+    bool Map(const std::filesystem::path& aPath);
+
+    // Builds the indexed layout in memory, used for the legacy formats.
+    void Build(const DescendantMap& aDescendants);
+
+    // Copies the mapped data to memory and releases the file, so it can be overwritten.
+    // Must not be called while the index is being queried.
+    void Detach();
+
+    [[nodiscard]] bool IsParent(Red::TweakDBID aRecordId) const;
+    [[nodiscard]] bool IsDescendant(Red::TweakDBID aRecordId) const;
+    [[nodiscard]] Red::TweakDBID GetParent(Red::TweakDBID aRecordId) const;
+    [[nodiscard]] std::span<const Red::TweakDBID> GetDescendants(Red::TweakDBID aParentId) const;
+
+    static Core::Vector<uint8_t> Serialize(const DescendantMap& aDescendants);
+
+private:
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numberOfParents;
+        uint32_t numberOfDescendants;
+        uint32_t numberOfRecords;
+        uint32_t reserved;
+    };
+
+    struct ParentEntry
+    {
+        Red::TweakDBID id;
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    static_assert(sizeof(Header) == 24);
+    static_assert(sizeof(ParentEntry) == 16);
+
+    bool Attach(const uint8_t* aData, size_t aSize);
+    void Reset();
+
+    [[nodiscard]] const ParentEntry* FindParent(Red::TweakDBID aParentId) const;
+    [[nodiscard]] const Red::TweakDBID* FindRecord(Red::TweakDBID aRecordId) const;
+
+    const ParentEntry* m_parents;
+    const Red::TweakDBID* m_descendants;
+    const Red::TweakDBID* m_records;
+    const uint32_t* m_recordParents;
+    uint32_t m_numberOfParents;
+    uint32_t m_numberOfDescendants;
+    uint32_t m_numberOfRecords;
+    Core::Vector<uint8_t> m_buffer;
+    wil::unique_hfile m_file;
+    wil::unique_handle m_mapping;
+    wil::unique_mapview_ptr<uint8_t> m_view;
+};
+}
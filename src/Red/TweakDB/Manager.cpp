@@ -1,11 +1,7 @@
 #include "Manager.hpp"
+#include "Core/Tracing/Tracer.hpp"
 #include "Red/TweakDB/Raws.hpp"
 
-namespace
-{
-constexpr auto OptimizedFlatChunkSize = 16000;
-}
-
 Red::TweakDBManager::TweakDBManager()
     : TweakDBManager(Red::TweakDB::Get())
 {
@@ -15,6 +11,7 @@ Red::TweakDBManager::TweakDBManager(Red::TweakDB* aTweakDb)
     : m_tweakDb(aTweakDb)
     , m_buffer(Core::MakeShared<Red::TweakDBBuffer>(m_tweakDb))
     , m_reflection(Core::MakeShared<Red::TweakDBReflection>(m_tweakDb))
+    , m_commitGuard(Core::MakeShared<bool>())
 {
 }
 
@@ -22,6 +19,7 @@ Red::TweakDBManager::TweakDBManager(Core::SharedPtr<Red::TweakDBReflection> aRef
     : m_tweakDb(aReflection->GetTweakDB())
     , m_buffer(Core::MakeShared<Red::TweakDBBuffer>(m_tweakDb))
     , m_reflection(std::move(aReflection))
+    , m_commitGuard(Core::MakeShared<bool>())
 {
 }
 
@@ -63,9 +61,16 @@ Red::Handle<Red::TweakDBRecord> Red::TweakDBManager::GetRecord(Red::TweakDBID aR
 
 const Red::CClass* Red::TweakDBManager::GetRecordType(Red::TweakDBID aRecordId)
 {
-    std::shared_lock recordLockR(m_tweakDb->mutex01);
-    const auto* record = m_tweakDb->recordsByID.Get(aRecordId);
-    return record ? record->GetPtr()->GetType() : nullptr;
+    {
+        std::shared_lock recordLockR(m_tweakDb->mutex01);
+        const auto* record = m_tweakDb->recordsByID.Get(aRecordId);
+
+        if (record)
+            return record->GetPtr()->GetType();
+    }
+
+    const auto* recordInfo = GetDeferredRecord(aRecordId);
+    return recordInfo ? recordInfo->type : nullptr;
 }
 
 bool Red::TweakDBManager::IsFlatExists(Red::TweakDBID aFlatId)
@@ -76,8 +81,14 @@ bool Red::TweakDBManager::IsFlatExists(Red::TweakDBID aFlatId)
 
 bool Red::TweakDBManager::IsRecordExists(Red::TweakDBID aRecordId)
 {
-    std::shared_lock recordLockR(m_tweakDb->mutex01);
-    return m_tweakDb->recordsByID.Get(aRecordId) != nullptr;
+    {
+        std::shared_lock recordLockR(m_tweakDb->mutex01);
+
+        if (m_tweakDb->recordsByID.Get(aRecordId))
+            return true;
+    }
+
+    return GetDeferredRecord(aRecordId) != nullptr;
 }
 
 bool Red::TweakDBManager::SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aInstance)
@@ -93,6 +104,87 @@ bool Red::TweakDBManager::SetFlat(Red::TweakDBID aFlatId, const Red::Value<>& aD
     return SetFlat(aFlatId, aData.type, aData.instance);
 }
 
+bool Red::TweakDBManager::SetFlats(std::span<const FlatAssignment> aFlats)
+{
+    auto success = true;
+
+    Core::Vector<const FlatAssignment*> assignments;
+    assignments.reserve(aFlats.size());
+
+    for (const auto& assignment : aFlats)
+    {
+        if (!assignment.first.IsValid() || !assignment.second.instance ||
+            !m_reflection->IsFlatType(assignment.second.type))
+        {
+            success = false;
+            continue;
+        }
+
+        assignments.push_back(&assignment);
+    }
+
+    std::stable_sort(assignments.begin(), assignments.end(), [](const auto* aLeft, const auto* aRight) {
+        return aLeft->first < aRight->first;
+    });
+
+    // When the same flat is assigned multiple times, the last value wins
+    {
+        size_t last = 0;
+        for (size_t i = 0; i < assignments.size(); ++i)
+        {
+            if (i + 1 < assignments.size() && assignments[i]->first == assignments[i + 1]->first)
+                continue;
+
+            assignments[last++] = assignments[i];
+        }
+        assignments.resize(last);
+    }
+
+    Core::Vector<int32_t> currentOffsets(assignments.size(), Red::TweakDBBuffer::InvalidOffset);
+
+    {
+        std::shared_lock flatLockR(m_tweakDb->mutex00);
+
+        // The input is sorted, so every search continues from the previous position
+        auto* flat = m_tweakDb->flats.Begin();
+        for (size_t i = 0; i < assignments.size(); ++i)
+        {
+            flat = std::lower_bound(flat, m_tweakDb->flats.End(), assignments[i]->first);
+
+            if (flat != m_tweakDb->flats.End() && *flat == assignments[i]->first)
+            {
+                currentOffsets[i] = flat->ToTDBOffset();
+            }
+        }
+    }
+
+    Core::Vector<Red::TweakDBID> changedFlats;
+    changedFlats.reserve(assignments.size());
+
+    for (size_t i = 0; i < assignments.size(); ++i)
+    {
+        const auto& [flatId, value] = *assignments[i];
+        const auto offset = m_buffer->AssignValue(currentOffsets[i], value.type, value.instance);
+
+        if (offset < 0)
+        {
+            success = false;
+            continue;
+        }
+
+        if (offset == currentOffsets[i])
+            continue;
+
+        auto changedId = flatId;
+        changedId.SetTDBOffset(offset);
+        changedFlats.push_back(changedId);
+    }
+
+    MergeFlats(changedFlats);
+
+    return success;
+}
+
 bool Red::TweakDBManager::CreateRecord(Red::TweakDBID aRecordId, const Red::CClass* aType)
 {
     if (!aRecordId.IsValid() || IsRecordExists(aRecordId))
@@ -103,11 +195,15 @@ bool Red::TweakDBManager::CreateRecord(Red::TweakDBID aRecordId, const Red::CCla
     if (!recordInfo)
         return false;
 
+    // The default values of the record info must not be refreshed by a compaction while they're inherited
+    const auto guard = StartCommit();
+
     Red::SortedUniqueArray<Red::TweakDBID> propFlats;
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo);
 
     {
+        std::unique_lock flatWriteLock(m_flatMutex);
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
     }
@@ -131,11 +227,14 @@ bool Red::TweakDBManager::CloneRecord(Red::TweakDBID aRecordId, Red::TweakDBID a
     if (!recordInfo)
         return false;
 
+    const auto guard = StartCommit();
+
     Red::SortedUniqueArray<Red::TweakDBID> propFlats;
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo, aSourceId);
 
     {
+        std::unique_lock flatWriteLock(m_flatMutex);
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
     }
@@ -164,11 +263,14 @@ bool Red::TweakDBManager::InheritProps(Red::TweakDBID aRecordId, Red::TweakDBID
     if (!recordInfo)
         return false;
 
+    const auto guard = StartCommit();
+
     Red::SortedUniqueArray<Red::TweakDBID> propFlats;
     propFlats.Reserve(recordInfo->props.size());
     InheritFlats(propFlats, aRecordId, recordInfo, aSourceId);
 
     {
+        std::unique_lock flatWriteLock(m_flatMutex);
         std::unique_lock flatLockRW(m_tweakDb->mutex00);
         m_tweakDb->flats.Insert(propFlats);
     }
@@ -190,6 +292,119 @@ bool Red::TweakDBManager::UpdateRecord(Red::TweakDBID aRecordId)
     return m_tweakDb->UpdateRecord(record);
 }
 
+Red::TweakDBManager::RecordStats Red::TweakDBManager::UpdateRecords(std::span<const Red::TweakDBID> aRecordIds)
+{
+    RecordStats stats;
+
+    Core::Vector<PendingRecord> pendingRecords;
+    pendingRecords.reserve(aRecordIds.size());
+
+    {
+        Core::Set<Red::TweakDBID> visitedRecords;
+
+        std::unique_lock _(m_mutex);
+
+        for (const auto& recordId : aRecordIds)
+        {
+            if (!recordId.IsValid())
+            {
+                stats.failed.push_back(recordId);
+                continue;
+            }
+
+            if (!visitedRecords.insert(recordId).second)
+            {
+                ++stats.avoided;
+                continue;
+            }
+
+            // A deferred record would have been built once when committed and rebuilt here
+            const auto deferredIt = m_deferredRecords.find(recordId);
+            if (deferredIt != m_deferredRecords.end())
+            {
+                pendingRecords.emplace_back(recordId, deferredIt->second);
+                m_deferredRecords.erase(deferredIt);
+                ++stats.avoided;
+                continue;
+            }
+
+            pendingRecords.emplace_back(recordId, nullptr);
+        }
+    }
+
+    CommitRecords(pendingRecords, stats);
+
+    return stats;
+}
+
+void Red::TweakDBManager::CommitRecords(std::span<const PendingRecord> aRecords, RecordStats& aStats)
+{
+    Core::Vector<std::pair<uint32_t, Red::TweakDBID>> newRecords;
+    Core::Vector<Red::Handle<Red::TweakDBRecord>> existingRecords;
+
+    {
+        std::shared_lock recordLockR(m_tweakDb->mutex01);
+
+        for (const auto& [recordId, recordInfo] : aRecords)
+        {
+            const auto* record = m_tweakDb->recordsByID.Get(recordId);
+
+            if (record)
+            {
+                existingRecords.push_back(*reinterpret_cast<const Red::Handle<Red::TweakDBRecord>*>(record));
+            }
+            else if (recordInfo)
+            {
+                newRecords.emplace_back(recordInfo->typeHash, recordId);
+            }
+            else
+            {
+                aStats.failed.push_back(recordId);
+            }
+        }
+    }
+
+    // Records of the same type are created and updated one after another
+    std::sort(newRecords.begin(), newRecords.end(), [](const auto& aLeft, const auto& aRight) {
+        return aLeft.first < aRight.first;
+    });
+
+    for (const auto& [typeHash, recordId] : newRecords)
+    {
+        Raw::CreateRecord(m_tweakDb, typeHash, recordId);
+        ++aStats.created;
+    }
+
+    if (!existingRecords.empty())
+    {
+        std::sort(existingRecords.begin(), existingRecords.end(), [](const auto& aLeft, const auto& aRight) {
+            return aLeft->GetType() < aRight->GetType();
+        });
+
+        std::unique_lock recordLockRW(m_tweakDb->mutex01);
+
+        for (const auto& record : existingRecords)
+        {
+            if (m_tweakDb->UpdateRecord(record))
+            {
+                ++aStats.updated;
+            }
+            else
+            {
+                aStats.failed.push_back(record->recordID);
+            }
+        }
+    }
+}
+
+const Red::TweakDBRecordInfo* Red::TweakDBManager::GetDeferredRecord(Red::TweakDBID aRecordId)
+{
+    std::shared_lock _(m_mutex);
+
+    const auto it = m_deferredRecords.find(aRecordId);
+    return it != m_deferredRecords.end() ? it->second : nullptr;
+}
+
 void Red::TweakDBManager::RegisterEnum(Red::TweakDBID aRecordId)
 {
     std::unique_lock _(m_mutex);
@@ -209,7 +424,10 @@ void Red::TweakDBManager::RegisterName(Red::TweakDBID aId, const std::string& aN
 
 Red::TweakDBManager::BatchPtr Red::TweakDBManager::StartBatch()
 {
-    return Core::MakeShared<Batch>();
+    auto batch = Core::MakeShared<Batch>();
+    batch->guard = StartCommit();
+
+    return batch;
 }
 
 const Core::Set<Red::TweakDBID>& Red::TweakDBManager::GetFlats(const Red::TweakDBManager::BatchPtr& aBatch)
@@ -373,8 +591,10 @@ void Red::TweakDBManager::RegisterName(const Red::TweakDBManager::BatchPtr& aBat
     aBatch->names.emplace(aId, aName);
 }
 
-void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch)
+void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch, bool aDeferRecords)
 {
+    Core::TraceSpan span("Committing batch", "TweakDB");
+
     std::unique_lock batchLockRW(aBatch->mutex);
 
     for (const auto& [id, name] : aBatch->names)
@@ -383,40 +603,33 @@ void Red::TweakDBManager::CommitBatch(const BatchPtr& aBatch)
     }
 
     {
-        Red::SortedUniqueArray<Red::TweakDBID> flatsChunk;
+        Core::Vector<Red::TweakDBID> batchFlats(aBatch->flats.begin(), aBatch->flats.end());
+        std::sort(batchFlats.begin(), batchFlats.end());
 
-        for (const auto& flatId : aBatch->flats)
+        RebuildFlats(batchFlats);
+    }
+
+    if (aDeferRecords)
+    {
+        std::unique_lock _(m_mutex);
+
+        // Updates of existing records have no record info, they must not replace a pending creation
+        for (const auto& [recordId, recordInfo] : aBatch->records)
         {
-            flatsChunk.InsertOrAssign(flatId);
+            auto& deferredInfo = m_deferredRecords[recordId];
 
-            if (flatsChunk.size >= OptimizedFlatChunkSize)
+            if (recordInfo)
             {
-                std::unique_lock flatLockRW(m_tweakDb->mutex00);
-                m_tweakDb->flats.InsertOrAssign(flatsChunk);
-                flatsChunk.Clear();
+                deferredInfo = recordInfo;
             }
         }
-
-        if (flatsChunk.size > 0)
-        {
-            std::unique_lock flatLockRW(m_tweakDb->mutex00);
-            m_tweakDb->flats.InsertOrAssign(flatsChunk);
-        }
     }
-
-    for (const auto& [recordId, recordInfo] : aBatch->records)
+    else if (!aBatch->records.empty())
     {
-        const auto record = GetRecord(recordId);
+        Core::Vector<PendingRecord> pendingRecords(aBatch->records.begin(), aBatch->records.end());
+        RecordStats stats;
 
-        if (record)
-        {
-            std::unique_lock recordLockRW(m_tweakDb->mutex01);
-            m_tweakDb->UpdateRecord(record);
-        }
-        else
-        {
-            Raw::CreateRecord(m_tweakDb, recordInfo->typeHash, recordId);
-        }
+        CommitRecords(pendingRecords, stats);
     }
 
     for (const auto& [id, name] : aBatch->names)
@@ -434,6 +647,40 @@ void Red::TweakDBManager::Invalidate()
     m_buffer->Invalidate();
 }
 
+void Red::TweakDBManager::SaveCheckpoint()
+{
+    m_buffer->SaveCheckpoint();
+}
+
+Red::TweakDBManager::CommitGuard Red::TweakDBManager::StartCommit()
+{
+    std::unique_lock flatWriteLock(m_flatMutex);
+    return m_commitGuard;
+}
+
+Red::TweakDBBuffer::BufferUsage Red::TweakDBManager::GetBufferUsage()
+{
+    return m_buffer->AnalyzeUsage();
+}
+
+std::optional<size_t> Red::TweakDBManager::CompactBuffer()
+{
+    // Holding the lock also keeps new commits from starting until the compaction is done
+    std::unique_lock flatWriteLock(m_flatMutex);
+
+    if (m_commitGuard.use_count() > 1)
+        return {};
+
+    const auto releasedBytes = m_buffer->Compact();
+
+    if (!releasedBytes)
+        return {};
+
+    m_reflection->RefreshDefaultValues();
+
+    return releasedBytes;
+}
+
 Red::TweakDB* Red::TweakDBManager::GetTweakDB()
 {
     return m_tweakDb;
@@ -460,25 +707,20 @@ bool Red::TweakDBManager::AssignFlat(Red::SortedUniqueArray<Red::TweakDBID>& aFl
         }
     }
 
-    if (offset >= 0)
-    {
-        const auto value = m_buffer->GetValue(offset);
-
-        if (value.type != aType)
-            return false;
+    const auto currentOffset = offset;
 
-        if (value.type->IsEqual(value.instance, aInstance))
-            return true;
-    }
-
-    offset = m_buffer->AllocateValue(aType, aInstance);
+    offset = m_buffer->AssignValue(currentOffset, aType, aInstance);
 
     if (offset < 0)
         return false;
 
+    if (offset == currentOffset)
+        return true;
+
     aFlatId.SetTDBOffset(offset);
 
     {
+        std::unique_lock flatWriteLock(m_flatMutex);
         std::unique_lock flatLockRW(aMutex);
         aFlats.InsertOrAssign(aFlatId);
     }
@@ -489,22 +731,27 @@ bool Red::TweakDBManager::AssignFlat(Red::SortedUniqueArray<Red::TweakDBID>& aFl
 void Red::TweakDBManager::InheritFlats(RED4ext::SortedUniqueArray<Red::TweakDBID>& aFlats, Red::TweakDBID aRecordId,
                                        const Red::TweakDBRecordInfo* aRecordInfo)
 {
-    for (const auto& [_, propInfo] : aRecordInfo->props)
+    // The array is created for a new record, so the flats are unique and can be appended and sorted once
+    aFlats.Reserve(static_cast<uint32_t>(aRecordInfo->flats.size()));
+
+    for (const auto& flatTemplate : aRecordInfo->flats)
     {
-        if (!propInfo->dataOffset)
+        if (!flatTemplate.isDataProp)
             continue;
 
-        auto propFlat = Red::TweakDBID(aRecordId, propInfo->appendix);
-        auto propDefault = propInfo->defaultValue;
+        auto propFlat = flatTemplate.GetFlatId(aRecordId);
+        auto propDefault = flatTemplate.defaultValue;
 
         if (propDefault < 0)
         {
-            propDefault = m_buffer->AllocateDefault(propInfo->type);
+            propDefault = m_buffer->AllocateDefault(flatTemplate.propInfo->type);
         }
 
         propFlat.SetTDBOffset(propDefault);
-        aFlats.Emplace(propFlat);
+        aFlats.entries[aFlats.size++] = propFlat;
     }
+
+    std::sort(aFlats.Begin(), aFlats.End());
 }
 
 void Red::TweakDBManager::InheritFlats(RED4ext::SortedUniqueArray<Red::TweakDBID>& aFlats, Red::TweakDBID aRecordId,
@@ -512,9 +759,9 @@ void Red::TweakDBManager::InheritFlats(RED4ext::SortedUniqueArray<Red::TweakDBID
 {
     std::shared_lock flatLockR(m_tweakDb->mutex00);
 
-    for (const auto& [_, propInfo] : aRecordInfo->props)
+    for (const auto& flatTemplate : aRecordInfo->flats)
     {
-        const auto baseId = aSourceId + propInfo->appendix;
+        const auto baseId = flatTemplate.GetFlatId(aSourceId);
         const auto* baseFlat = aFlats.Find(baseId);
 
         if (baseFlat == aFlats.End())
@@ -524,7 +771,7 @@ void Red::TweakDBManager::InheritFlats(RED4ext::SortedUniqueArray<Red::TweakDBID
                 continue;
         }
 
-        auto propFlat = aRecordId + propInfo->appendix;
+        auto propFlat = flatTemplate.GetFlatId(aRecordId);
         propFlat.SetTDBOffset(baseFlat->ToTDBOffset());
 
         aFlats.Emplace(propFlat);
@@ -534,38 +781,41 @@ void Red::TweakDBManager::InheritFlats(RED4ext::SortedUniqueArray<Red::TweakDBID
 bool Red::TweakDBManager::AssignFlat(const Red::TweakDBManager::BatchPtr& aBatch, Red::TweakDBID aFlatId,
                                      const Red::Value<>& aValue)
 {
-    std::unique_lock batchLockRW(aBatch->mutex);
-
-    const auto& flat = aBatch->flats.find(aFlatId);
     int32_t offset = -1;
 
-    if (flat != aBatch->flats.end())
     {
-        offset = flat->ToTDBOffset();
-
-        const auto value = m_buffer->GetValue(offset);
-
-        if (value.type != aValue.type)
-            return false;
-
-        if (value.type->IsEqual(value.instance, aValue.instance))
-            return true;
+        std::shared_lock batchLockR(aBatch->mutex);
+        const auto& flat = aBatch->flats.find(aFlatId);
+        if (flat != aBatch->flats.end())
+        {
+            offset = flat->ToTDBOffset();
+        }
     }
 
-    offset = m_buffer->AllocateValue(aValue);
+    const auto currentOffset = offset;
+
+    offset = m_buffer->AssignValue(currentOffset, aValue.type, aValue.instance);
 
     if (offset < 0)
         return false;
 
-    aFlatId.SetTDBOffset(offset);
+    if (offset == currentOffset)
+        return true;
+
+    auto flatId = aFlatId;
+    flatId.SetTDBOffset(offset);
 
-    if (flat != aBatch->flats.end())
-    {
-        const_cast<Red::TweakDBID&>(*flat) = aFlatId;
-    }
-    else
     {
-        aBatch->flats.insert(aFlatId);
+        std::unique_lock batchLockRW(aBatch->mutex);
+        const auto& flat = aBatch->flats.find(aFlatId);
+        if (flat != aBatch->flats.end())
+        {
+            const_cast<Red::TweakDBID&>(*flat) = flatId;
+        }
+        else
+        {
+            aBatch->flats.insert(flatId);
+        }
     }
 
     return true;
@@ -574,20 +824,20 @@ bool Red::TweakDBManager::AssignFlat(const Red::TweakDBManager::BatchPtr& aBatch
 void Red::TweakDBManager::InheritFlats(const Red::TweakDBManager::BatchPtr& aBatch, Red::TweakDBID aRecordId,
                                        const Red::TweakDBRecordInfo* aRecordInfo)
 {
-    for (const auto& [_, propInfo] : aRecordInfo->props)
+    for (const auto& flatTemplate : aRecordInfo->flats)
     {
-        if (!propInfo->dataOffset)
+        if (!flatTemplate.isDataProp)
             continue;
 
-        auto propFlat = Red::TweakDBID(aRecordId, propInfo->appendix);
+        auto propFlat = flatTemplate.GetFlatId(aRecordId);
 
         if (!aBatch->flats.contains(propFlat))
         {
-            auto propDefault = propInfo->defaultValue;
+            auto propDefault = flatTemplate.defaultValue;
 
             if (propDefault < 0)
             {
-                propDefault = m_buffer->AllocateDefault(propInfo->type);
+                propDefault = m_buffer->AllocateDefault(flatTemplate.propInfo->type);
             }
 
             propFlat.SetTDBOffset(propDefault);
@@ -602,14 +852,14 @@ void Red::TweakDBManager::InheritFlats(const Red::TweakDBManager::BatchPtr& aBat
 {
     std::shared_lock flatLockR(m_tweakDb->mutex00);
 
-    for (const auto& [_, propInfo] : aRecordInfo->props)
+    for (const auto& flatTemplate : aRecordInfo->flats)
     {
-        const auto baseId = aSourceId + propInfo->appendix;
+        const auto baseId = flatTemplate.GetFlatId(aSourceId);
         const auto baseFlat = aBatch->flats.find(baseId);
 
         if (baseFlat != aBatch->flats.end())
         {
-            auto propFlat = aRecordId + propInfo->appendix;
+            auto propFlat = flatTemplate.GetFlatId(aRecordId);
             propFlat.SetTDBOffset(baseFlat->ToTDBOffset());
 
             aBatch->flats.insert(propFlat);
@@ -619,7 +869,7 @@ void Red::TweakDBManager::InheritFlats(const Red::TweakDBManager::BatchPtr& aBat
             auto commitedFlat = m_tweakDb->flats.Find(baseId);
             if (commitedFlat != m_tweakDb->flats.End())
             {
-                auto propFlat = aRecordId + propInfo->appendix;
+                auto propFlat = flatTemplate.GetFlatId(aRecordId);
                 propFlat.SetTDBOffset(commitedFlat->ToTDBOffset());
 
                 aBatch->flats.insert(propFlat);
@@ -628,15 +878,153 @@ void Red::TweakDBManager::InheritFlats(const Red::TweakDBManager::BatchPtr& aBat
     }
 }
 
+void Red::TweakDBManager::MergeFlats(std::span<const Red::TweakDBID> aFlats)
+{
+    if (aFlats.empty())
+        return;
+
+    auto& flats = m_tweakDb->flats;
+
+    std::unique_lock flatWriteLock(m_flatMutex);
+    std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+    // Both sequences are sorted, so the number of new flats can be counted in one pass...
+    uint32_t newFlats = 0;
+    {
+        uint32_t i = 0;
+        size_t j = 0;
+        while (j < aFlats.size())
+        {
+            if (i < flats.size && flats.entries[i] < aFlats[j])
+            {
+                ++i;
+            }
+            else
+            {
+                if (i < flats.size && !(aFlats[j] < flats.entries[i]))
+                    ++i;
+                else
+                    ++newFlats;
+
+                ++j;
+            }
+        }
+    }
+
+    // ...and then merged from the back, so every existing flat is moved at most once.
+    flats.Reserve(flats.size + newFlats);
+
+    auto i = flats.size;
+    auto j = aFlats.size();
+    auto k = flats.size + newFlats;
+
+    while (j > 0)
+    {
+        if (i > 0 && aFlats[j - 1] < flats.entries[i - 1])
+        {
+            flats.entries[--k] = flats.entries[--i];
+        }
+        else
+        {
+            if (i > 0 && !(flats.entries[i - 1] < aFlats[j - 1]))
+                --i;
+
+            flats.entries[--k] = aFlats[--j];
+        }
+    }
+
+    flats.size += newFlats;
+}
+
+void Red::TweakDBManager::RebuildFlats(std::span<const Red::TweakDBID> aFlats)
+{
+    if (aFlats.empty())
+        return;
+
+    Red::SortedUniqueArray<Red::TweakDBID> mergedFlats;
+
+    std::unique_lock flatWriteLock(m_flatMutex);
+
+    // The game and other mods don't use our lock and can change flats in place without any trace,
+    // so the merge must happen under their lock to not overwrite their changes with a stale copy.
+    std::unique_lock flatLockRW(m_tweakDb->mutex00);
+
+    MergeFlats(m_tweakDb->flats, aFlats, mergedFlats);
+
+    std::swap(m_tweakDb->flats.entries, mergedFlats.entries);
+    std::swap(m_tweakDb->flats.size, mergedFlats.size);
+    std::swap(m_tweakDb->flats.capacity, mergedFlats.capacity);
+}
+
+void Red::TweakDBManager::MergeFlats(const Red::SortedUniqueArray<Red::TweakDBID>& aFlats,
+                                     std::span<const Red::TweakDBID> aChanges,
+                                     Red::SortedUniqueArray<Red::TweakDBID>& aResult)
+{
+    uint32_t newFlats = 0;
+    {
+        uint32_t i = 0;
+        size_t j = 0;
+        while (j < aChanges.size())
+        {
+            if (i < aFlats.size && aFlats.entries[i] < aChanges[j])
+            {
+                ++i;
+            }
+            else
+            {
+                if (i < aFlats.size && !(aChanges[j] < aFlats.entries[i]))
+                    ++i;
+                else
+                    ++newFlats;
+
+                ++j;
+            }
+        }
+    }
+
+    aResult.Clear();
+    aResult.Reserve(aFlats.size + newFlats);
+
+    uint32_t i = 0;
+    size_t j = 0;
+    uint32_t k = 0;
+
+    while (i < aFlats.size && j < aChanges.size())
+    {
+        if (aFlats.entries[i] < aChanges[j])
+        {
+            aResult.entries[k++] = aFlats.entries[i++];
+        }
+        else
+        {
+            if (!(aChanges[j] < aFlats.entries[i]))
+                ++i;
+
+            aResult.entries[k++] = aChanges[j++];
+        }
+    }
+
+    if (i < aFlats.size)
+    {
+        std::copy(aFlats.entries + i, aFlats.entries + aFlats.size, aResult.entries + k);
+        k += aFlats.size - i;
+    }
+
+    if (j < aChanges.size())
+    {
+        std::copy(aChanges.begin() + j, aChanges.end(), aResult.entries + k);
+        k += static_cast<uint32_t>(aChanges.size() - j);
+    }
+
+    aResult.size = k;
+}
+
 void Red::TweakDBManager::CreateBaseName(Red::TweakDBID aId, const std::string& aName)
 {
     Red::TweakDBID empty;
     Raw::CreateTweakDBID(&empty, &aId, aName.c_str());
 
-    {
-        std::unique_lock _(m_mutex);
-        m_knownNames[aId] = aName;
-    }
+    m_knownNames.Add(aId, aName);
 }
 
 void Red::TweakDBManager::CreateExtraNames(Red::TweakDBID aId, const std::string& aName, const Red::CClass* aType)
@@ -646,12 +1034,12 @@ void Red::TweakDBManager::CreateExtraNames(Red::TweakDBID aId, const std::string
     if (!recordInfo)
         return;
 
-    std::unique_lock _(m_mutex);
+    // Property names only reference the interned record name and appendix
+    const auto recordName = m_knownNames.Add(aId, aName);
 
     for (const auto& [propKey, propInfo] : recordInfo->props)
     {
         const auto propId = aId + propInfo->appendix;
-        const auto propName = aName + propInfo->appendix;
 
         if (propInfo->dataOffset)
         {
@@ -659,36 +1047,59 @@ void Red::TweakDBManager::CreateExtraNames(Red::TweakDBID aId, const std::string
         }
         else
         {
+            const auto propName = aName + propInfo->appendix;
+
             Red::TweakDBID empty;
             Raw::CreateTweakDBID(&empty, &propId, propName.c_str());
         }
 
-        m_knownNames[propId] = propName;
+        m_knownNames.Add(propId, recordName, propInfo->appendix);
     }
 }
 
 std::string_view Red::TweakDBManager::GetName(Red::TweakDBID aId)
 {
-    {
-        std::shared_lock _(m_mutex);
+    auto name = m_knownNames.Find(aId);
+    if (!name.empty())
+        return name;
+
+    // The name is resolved without holding a lock, only one shard of the table waits for the insertion
+    return m_knownNames.AddResolved(aId, ResolveName(aId));
+}
+
+void Red::TweakDBManager::ResolveNames(std::span<const Red::TweakDBID> aIds)
+{
+    Core::Vector<Red::TweakDBNameTable::ResolvedName> resolvedNames;
 
-        auto it = m_knownNames.find(aId);
-        if (it != m_knownNames.end())
-            return it->second;
+    for (const auto& id : aIds)
+    {
+        if (!m_knownNames.Contains(id))
+        {
+            resolvedNames.emplace_back(id, ResolveName(id));
+        }
     }
 
-    std::unique_lock _(m_mutex);
+    if (!resolvedNames.empty())
+    {
+        m_knownNames.AddResolved(resolvedNames);
+    }
+}
 
+std::string Red::TweakDBManager::ResolveName(Red::TweakDBID aId)
+{
     auto debugName = m_reflection->ToString(aId);
-    if (!debugName.empty())
+
+    if (debugName.empty())
     {
-        auto it = m_knownNames.emplace(aId, debugName).first;
-        return it->second;
+        debugName = std::format("<TDBID:{:08X}:{:02X}>", aId.name.hash, aId.name.length);
     }
 
-    auto hashName = std::format("<TDBID:{:08X}:{:02X}>", aId.name.hash, aId.name.length);
-    auto it = m_knownNames.emplace(aId, hashName).first;
-    return it->second;
+    return debugName;
+}
+
+Red::TweakDBNameTable::NameStats Red::TweakDBManager::GetNameStats()
+{
+    return m_knownNames.GetStats();
 }
 
 const Core::Set<Red::TweakDBID>& Red::TweakDBManager::GetEnums()
@@ -2,6 +2,7 @@
 
 #include "Red/TweakDB/Alias.hpp"
 #include "Red/TweakDB/Buffer.hpp"
+#include "Red/TweakDB/NameTable.hpp"
 #include "Red/TweakDB/Reflection.hpp"
 
 namespace Red
@@ -9,8 +10,11 @@ namespace Red
 class TweakDBManager
 {
 public:
+    using CommitGuard = Core::SharedPtr<void>;
+
     class Batch
     {
+        CommitGuard guard;
         Core::Set<Red::TweakDBID> flats;
         Core::Map<Red::TweakDBID, const Red::TweakDBRecordInfo*> records;
         Core::Map<Red::TweakDBID, const std::string> names;
@@ -19,6 +23,15 @@ public:
     };
 
     using BatchPtr = Core::SharedPtr<Batch>;
+    using FlatAssignment = std::pair<Red::TweakDBID, Red::Value<>>;
+
+    struct RecordStats
+    {
+        size_t created = 0;
+        size_t updated = 0;
+        size_t avoided = 0; // rebuilds skipped for deferred or repeated records
+        Core::Vector<Red::TweakDBID> failed;
+    };
 
     TweakDBManager();
     explicit TweakDBManager(Red::TweakDB* aTweakDb);
@@ -35,15 +48,19 @@ public:
     bool IsRecordExists(Red::TweakDBID aRecordId);
     bool SetFlat(Red::TweakDBID aFlatId, const Red::CBaseRTTIType* aType, Red::Instance aInstance);
     bool SetFlat(Red::TweakDBID aFlatId, const Red::Value<>& aData);
+    bool SetFlats(std::span<const FlatAssignment> aFlats);
     bool CreateRecord(Red::TweakDBID aRecordId, const Red::CClass* aType);
     bool CloneRecord(Red::TweakDBID aRecordId, Red::TweakDBID aSourceId);
     bool InheritProps(Red::TweakDBID aRecordId, Red::TweakDBID aSourceId);
     bool UpdateRecord(Red::TweakDBID aRecordId);
+    RecordStats UpdateRecords(std::span<const Red::TweakDBID> aRecordIds);
     void RegisterEnum(Red::TweakDBID aRecordId);
     void RegisterName(const std::string& aName, const Red::CClass* aType = nullptr);
     void RegisterName(Red::TweakDBID aId, const std::string& aName, const Red::CClass* aType = nullptr);
     const Core::Set<Red::TweakDBID>& GetEnums();
     std::string_view GetName(Red::TweakDBID aId);
+    void ResolveNames(std::span<const Red::TweakDBID> aIds);
+    Red::TweakDBNameTable::NameStats GetNameStats();
 
     BatchPtr StartBatch();
     const Core::Set<Red::TweakDBID>& GetFlats(const BatchPtr& aBatch);
@@ -59,9 +76,24 @@ public:
     bool UpdateRecord(const BatchPtr& aBatch, Red::TweakDBID aRecordId);
     void RegisterEnum(const BatchPtr& aBatch, Red::TweakDBID aRecordId);
     void RegisterName(const BatchPtr& aBatch, Red::TweakDBID aId, const std::string& aName);
-    void CommitBatch(const BatchPtr& aBatch);
+    // With deferred records, the records of the batch are only created or updated by the next UpdateRecords
+    // that includes them, until then they're reported as existing.
+    void CommitBatch(const BatchPtr& aBatch, bool aDeferRecords = false);
 
     void Invalidate();
+    void SaveCheckpoint();
+
+    // Merges sorted unique flats into a new array in one linear pass, the changes replace existing flats.
+    static void MergeFlats(const Red::SortedUniqueArray<Red::TweakDBID>& aFlats,
+                           std::span<const Red::TweakDBID> aChanges, Red::SortedUniqueArray<Red::TweakDBID>& aResult);
+
+    // Batches and commits can hold buffer values between calls, so the buffer is only compacted
+    // when none of them is in flight. A commit is in flight for as long as its guard is alive.
+    CommitGuard StartCommit();
+
+    Red::TweakDBBuffer::BufferUsage GetBufferUsage();
+    // Returns the number of released bytes, or nothing if the buffer can't be compacted at this point.
+    std::optional<size_t> CompactBuffer();
 
     Red::TweakDB* GetTweakDB();
     Core::SharedPtr<Red::TweakDBReflection>& GetReflection();
@@ -83,14 +115,26 @@ private:
     inline void InheritFlats(const Red::TweakDBManager::BatchPtr& aBatch, Red::TweakDBID aRecordId,
                              const Red::TweakDBRecordInfo* aRecordInfo, Red::TweakDBID aSourceId);
 
+    using PendingRecord = std::pair<Red::TweakDBID, const Red::TweakDBRecordInfo*>;
+
+    void CommitRecords(std::span<const PendingRecord> aRecords, RecordStats& aStats);
+    const Red::TweakDBRecordInfo* GetDeferredRecord(Red::TweakDBID aRecordId);
+
+    void MergeFlats(std::span<const Red::TweakDBID> aFlats);
+    void RebuildFlats(std::span<const Red::TweakDBID> aFlats);
+
     void CreateBaseName(Red::TweakDBID aId, const std::string& aName);
     void CreateExtraNames(Red::TweakDBID aId, const std::string& aName, const Red::CClass* aType = nullptr);
+    std::string ResolveName(Red::TweakDBID aId);
 
     Red::TweakDB* m_tweakDb;
     Core::SharedPtr<Red::TweakDBBuffer> m_buffer;
     Core::SharedPtr<Red::TweakDBReflection> m_reflection;
-    Core::Map<Red::TweakDBID, std::string> m_knownNames;
+    Red::TweakDBNameTable m_knownNames;
     Core::Set<Red::TweakDBID> m_knownEnums;
+    Core::Map<Red::TweakDBID, const Red::TweakDBRecordInfo*> m_deferredRecords;
     std::shared_mutex m_mutex;
+    std::mutex m_flatMutex; // Serializes the writers of the database flats
+    CommitGuard m_commitGuard; // Only copied under m_flatMutex
 };
 }
@@ -0,0 +1,283 @@
+#include "NameTable.hpp"
+
+namespace
+{
+constexpr auto ArenaBlockSize = 64 * 1024;
+}
+
+std::string_view Red::TweakDBNameTable::Add(Red::TweakDBID aId, std::string_view aName)
+{
+    auto& shard = GetShard(aId);
+
+    std::unique_lock shardLockRW(shard.mutex);
+
+    auto it = shard.entries.find(aId);
+    if (it != shard.entries.end())
+    {
+        const auto* existing = it->second;
+        if (!existing->appendix && aName == std::string_view{existing->prefix, existing->prefixLength})
+            return {existing->prefix, existing->prefixLength};
+    }
+
+    auto* entry = CreateEntry(shard, aName);
+    shard.entries.insert_or_assign(aId, entry);
+
+    return {entry->prefix, entry->prefixLength};
+}
+
+void Red::TweakDBNameTable::Add(Red::TweakDBID aId, std::string_view aPrefix, std::string_view aAppendix)
+{
+    const auto appendix = InternAppendix(aAppendix);
+
+    auto& shard = GetShard(aId);
+
+    std::unique_lock shardLockRW(shard.mutex);
+
+    auto it = shard.entries.find(aId);
+    if (it != shard.entries.end())
+    {
+        const auto* existing = it->second;
+        if (existing->prefix == aPrefix.data() && existing->prefixLength == aPrefix.size() &&
+            existing->appendix == appendix.data())
+            return;
+    }
+
+    Entry* entry;
+    {
+        std::unique_lock arenaLockRW(shard.arenaMutex);
+        entry = new (shard.arena.Allocate(sizeof(Entry), alignof(Entry))) Entry{};
+    }
+
+    entry->prefix = aPrefix.data();
+    entry->prefixLength = static_cast<uint32_t>(aPrefix.size());
+    entry->appendix = appendix.data();
+    entry->appendixLength = static_cast<uint32_t>(appendix.size());
+
+    shard.entries.insert_or_assign(aId, entry);
+}
+
+std::string_view Red::TweakDBNameTable::AddResolved(Red::TweakDBID aId, std::string_view aName)
+{
+    auto& shard = GetShard(aId);
+
+    std::unique_lock shardLockRW(shard.mutex);
+
+    return AddResolved(shard, aId, aName);
+}
+
+void Red::TweakDBNameTable::AddResolved(std::span<const ResolvedName> aNames)
+{
+    // Group the names by shard, so each lock is taken once
+    std::array<Core::Vector<const ResolvedName*>, ShardCount> shardNames;
+
+    for (const auto& resolvedName : aNames)
+    {
+        shardNames[GetShardIndex(resolvedName.first)].push_back(&resolvedName);
+    }
+
+    for (size_t i = 0; i < ShardCount; ++i)
+    {
+        if (shardNames[i].empty())
+            continue;
+
+        auto& shard = m_shards[i];
+
+        std::unique_lock shardLockRW(shard.mutex);
+
+        for (const auto* resolvedName : shardNames[i])
+        {
+            AddResolved(shard, resolvedName->first, resolvedName->second);
+        }
+    }
+}
+
+std::string_view Red::TweakDBNameTable::AddResolved(Shard& aShard, Red::TweakDBID aId, std::string_view aName)
+{
+    auto it = aShard.entries.find(aId);
+    if (it != aShard.entries.end())
+        return GetName(aShard, it->second);
+
+    it = aShard.resolved.find(aId);
+    if (it != aShard.resolved.end())
+        return GetName(aShard, it->second);
+
+    auto* entry = CreateEntry(aShard, aName);
+    aShard.resolved.emplace(aId, entry);
+
+    return {entry->prefix, entry->prefixLength};
+}
+
+std::string_view Red::TweakDBNameTable::Find(Red::TweakDBID aId)
+{
+    auto& shard = GetShard(aId);
+
+    Entry* entry;
+
+    {
+        std::shared_lock shardLockR(shard.mutex);
+
+        auto it = shard.entries.find(aId);
+        if (it == shard.entries.end())
+        {
+            it = shard.resolved.find(aId);
+            if (it == shard.resolved.end())
+                return {};
+        }
+
+        entry = it->second;
+    }
+
+    return GetName(shard, entry);
+}
+
+bool Red::TweakDBNameTable::Contains(Red::TweakDBID aId)
+{
+    auto& shard = GetShard(aId);
+
+    std::shared_lock shardLockR(shard.mutex);
+
+    return shard.entries.contains(aId) || shard.resolved.contains(aId);
+}
+
+std::string_view Red::TweakDBNameTable::GetName(Shard& aShard, Entry* aEntry)
+{
+    const auto length = aEntry->prefixLength + aEntry->appendixLength;
+    const auto* name = aEntry->name.load(std::memory_order_acquire);
+
+    if (!name)
+    {
+        std::unique_lock arenaLockRW(aShard.arenaMutex);
+
+        name = aEntry->name.load(std::memory_order_relaxed);
+
+        if (!name)
+        {
+            auto* data = aShard.arena.Allocate(length + 1);
+            std::memcpy(data, aEntry->prefix, aEntry->prefixLength);
+            std::memcpy(data + aEntry->prefixLength, aEntry->appendix, aEntry->appendixLength);
+            data[length] = '\0';
+
+            aEntry->name.store(data, std::memory_order_release);
+            ++aShard.builtNames;
+
+            name = data;
+        }
+    }
+
+    return {name, length};
+}
+
+Red::TweakDBNameTable::Entry* Red::TweakDBNameTable::CreateEntry(Shard& aShard, std::string_view aName)
+{
+    std::unique_lock arenaLockRW(aShard.arenaMutex);
+
+    auto* data = aShard.arena.Store(aName);
+
+    auto* entry = new (aShard.arena.Allocate(sizeof(Entry), alignof(Entry))) Entry{};
+    entry->name.store(data, std::memory_order_relaxed);
+    entry->prefix = data;
+    entry->prefixLength = static_cast<uint32_t>(aName.size());
+
+    return entry;
+}
+
+std::string_view Red::TweakDBNameTable::InternAppendix(std::string_view aAppendix)
+{
+    {
+        std::shared_lock appendixLockR(m_appendixMutex);
+
+        auto it = m_appendices.find(aAppendix);
+        if (it != m_appendices.end())
+            return *it;
+    }
+
+    std::unique_lock appendixLockRW(m_appendixMutex);
+
+    auto it = m_appendices.find(aAppendix);
+    if (it != m_appendices.end())
+        return *it;
+
+    std::string_view appendix{m_appendixArena.Store(aAppendix), aAppendix.size()};
+    m_appendices.insert(appendix);
+
+    return appendix;
+}
+
+size_t Red::TweakDBNameTable::GetShardIndex(Red::TweakDBID aId)
+{
+    return (aId.name.hash ^ (aId.name.hash >> 16) ^ aId.name.length) % ShardCount;
+}
+
+Red::TweakDBNameTable::Shard& Red::TweakDBNameTable::GetShard(Red::TweakDBID aId)
+{
+    return m_shards[GetShardIndex(aId)];
+}
+
+char* Red::TweakDBNameTable::Arena::Allocate(size_t aSize, size_t aAlignment)
+{
+    auto padding = (aAlignment - reinterpret_cast<uintptr_t>(blockPos) % aAlignment) % aAlignment;
+
+    if (padding + aSize > blockLeft)
+    {
+        // The blocks are never reallocated, so the previous strings stay in place
+        const auto blockSize = std::max<size_t>(ArenaBlockSize, aSize + aAlignment);
+
+        auto& block = blocks.emplace_back(blockSize);
+        blockPos = block.data();
+        blockLeft = block.size();
+        size += block.size();
+
+        padding = (aAlignment - reinterpret_cast<uintptr_t>(blockPos) % aAlignment) % aAlignment;
+    }
+
+    auto* data = blockPos + padding;
+    blockPos += padding + aSize;
+    blockLeft -= padding + aSize;
+    used += padding + aSize;
+
+    return data;
+}
+
+char* Red::TweakDBNameTable::Arena::Store(std::string_view aString)
+{
+    auto* data = Allocate(aString.size() + 1);
+    std::memcpy(data, aString.data(), aString.size());
+    data[aString.size()] = '\0';
+
+    return data;
+}
+
+Red::TweakDBNameTable::NameStats Red::TweakDBNameTable::GetStats() const
+{
+    NameStats stats;
+
+    for (const auto& shard : m_shards)
+    {
+        std::shared_lock shardLockR(shard.mutex);
+
+        stats.names += shard.entries.size();
+        stats.sharedNames += std::count_if(shard.entries.begin(), shard.entries.end(), [](const auto& aItem) {
+            return aItem.second->appendix != nullptr;
+        });
+        stats.resolvedNames += shard.resolved.size();
+        stats.indexSize += (shard.entries.bucket_count() + shard.resolved.bucket_count()) *
+                           sizeof(std::pair<Red::TweakDBID, Entry*>);
+
+        std::unique_lock arenaLockRW(shard.arenaMutex);
+
+        stats.builtNames += shard.builtNames;
+        stats.arenaSize += shard.arena.size;
+        stats.arenaUsed += shard.arena.used;
+    }
+
+    {
+        std::shared_lock appendixLockR(m_appendixMutex);
+
+        stats.appendices = m_appendices.size();
+        stats.indexSize += m_appendices.bucket_count() * sizeof(std::string_view);
+        stats.arenaSize += m_appendixArena.size;
+        stats.arenaUsed += m_appendixArena.used;
+    }
+
+    return stats;
+}
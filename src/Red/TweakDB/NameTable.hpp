@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Red/TweakDB/Alias.hpp"
+
+namespace Red
+{
+// Interned storage for the names of TweakDBIDs.
+//
+// All strings live in large arena blocks that are never moved or freed while the table exists,
+// so the returned views stay valid even if a name is registered again.
+// Property names are stored as a reference to the interned record name plus a shared appendix,
+// the contiguous string is only built the first time it's requested.
+//
+// The table is split into shards by ID, each with its own lock and arena,
+// so concurrent lookups and registrations rarely touch the same lock.
+class TweakDBNameTable
+{
+public:
+    using ResolvedName = std::pair<Red::TweakDBID, std::string>;
+
+    struct NameStats
+    {
+        size_t names = 0;
+        size_t sharedNames = 0; // names stored as record name + appendix
+        size_t builtNames = 0; // shared names that were requested as a whole
+        size_t resolvedNames = 0; // names resolved from the game on lookup
+        size_t appendices = 0;
+        size_t arenaSize = 0; // bytes
+        size_t arenaUsed = 0; // bytes
+        size_t indexSize = 0; // bytes
+    };
+
+    TweakDBNameTable() = default;
+
+    TweakDBNameTable(const TweakDBNameTable&) = delete;
+    TweakDBNameTable& operator=(const TweakDBNameTable&) = delete;
+
+    // Stores the full name and returns the interned view, which can be used as a prefix for other names.
+    std::string_view Add(Red::TweakDBID aId, std::string_view aName);
+
+    // Stores the name as a prefix followed by an appendix,
+    // the prefix must be a view previously returned by the table.
+    void Add(Red::TweakDBID aId, std::string_view aPrefix, std::string_view aAppendix);
+
+    // Stores the names that were resolved for unknown IDs.
+    // Resolved names never replace registered names.
+    std::string_view AddResolved(Red::TweakDBID aId, std::string_view aName);
+    void AddResolved(std::span<const ResolvedName> aNames);
+
+    // Returns an empty view if the name is unknown.
+    std::string_view Find(Red::TweakDBID aId);
+    bool Contains(Red::TweakDBID aId);
+
+    [[nodiscard]] NameStats GetStats() const;
+
+private:
+    static constexpr size_t ShardCount = 32;
+
+    struct Entry
+    {
+        std::atomic<const char*> name;
+        const char* prefix;
+        const char* appendix;
+        uint32_t prefixLength;
+        uint32_t appendixLength;
+    };
+
+    struct Arena
+    {
+        char* Allocate(size_t aSize, size_t aAlignment = 1);
+        char* Store(std::string_view aString);
+
+        Core::Vector<Core::Vector<char>> blocks;
+        char* blockPos{nullptr};
+        size_t blockLeft{0};
+        size_t size{0};
+        size_t used{0};
+    };
+
+    struct Shard
+    {
+        Core::Map<Red::TweakDBID, Entry*> entries;
+        Core::Map<Red::TweakDBID, Entry*> resolved;
+        Arena arena;
+        size_t builtNames{0};
+        mutable std::shared_mutex mutex;
+        mutable std::mutex arenaMutex; // Guards the arena, which is also written by lookups
+    };
+
+    static inline size_t GetShardIndex(Red::TweakDBID aId);
+    inline Shard& GetShard(Red::TweakDBID aId);
+
+    inline std::string_view GetName(Shard& aShard, Entry* aEntry);
+    inline std::string_view AddResolved(Shard& aShard, Red::TweakDBID aId, std::string_view aName);
+
+    Entry* CreateEntry(Shard& aShard, std::string_view aName);
+    std::string_view InternAppendix(std::string_view aAppendix);
+
+    std::array<Shard, ShardCount> m_shards;
+    Core::Set<std::string_view> m_appendices;
+    Arena m_appendixArena;
+    mutable std::shared_mutex m_appendixMutex;
+};
+}
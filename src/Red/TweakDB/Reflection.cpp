@@ -20,6 +20,121 @@ constexpr auto ScriptResRefArrayTypeName = Red::GetTypeName<Red::DynArray<Red::R
 constexpr auto NameSeparator = Red::TweakGrammar::Name::Separator;
 constexpr auto PropSeparator = std::string_view(NameSeparator);
 constexpr auto DataOffsetSize = 12;
+
+constexpr uint32_t HashProbeSeeds[] = {0x9E3779B9, 0x85EBCA6B, 0xC2B2AE35};
+
+uint32_t HashAppendix(uint32_t aSeed, const std::string& aAppendix)
+{
+    Red::TweakDBID baseId;
+    baseId.name.hash = aSeed;
+    return Red::TweakDBID(baseId, aAppendix).name.hash;
+}
+
+template<typename T>
+Red::InstancePtr<> ConstructFlat()
+{
+    return Red::MakeInstance<T>();
+}
+
+template<typename T>
+constexpr Red::TweakDBFlatTypeInfo MakeFlatType(uint64_t aName, uint64_t aArrayName)
+{
+    return {aName, 0, aArrayName, sizeof(T), 0, false, std::is_same_v<T, Red::CString>, &ConstructFlat<T>};
+}
+
+template<typename T>
+constexpr Red::TweakDBFlatTypeInfo MakeArrayFlatType(uint64_t aName, uint64_t aElementName)
+{
+    return {aName,
+            aElementName,
+            0,
+            sizeof(Red::DynArray<T>),
+            sizeof(T),
+            true,
+            std::is_same_v<T, Red::CString>,
+            &ConstructFlat<Red::DynArray<T>>};
+}
+
+constexpr Red::TweakDBFlatTypeInfo FlatTypes[] = {
+    MakeFlatType<int>(Red::ERTDBFlatType::Int, Red::ERTDBFlatType::IntArray),
+    MakeFlatType<float>(Red::ERTDBFlatType::Float, Red::ERTDBFlatType::FloatArray),
+    MakeFlatType<bool>(Red::ERTDBFlatType::Bool, Red::ERTDBFlatType::BoolArray),
+    MakeFlatType<Red::CString>(Red::ERTDBFlatType::String, Red::ERTDBFlatType::StringArray),
+    MakeFlatType<Red::CName>(Red::ERTDBFlatType::CName, Red::ERTDBFlatType::CNameArray),
+    MakeFlatType<Red::LocKeyWrapper>(Red::ERTDBFlatType::LocKey, Red::ERTDBFlatType::LocKeyArray),
+    MakeFlatType<Red::ResourceAsyncReference<>>(Red::ERTDBFlatType::ResRef, Red::ERTDBFlatType::ResRefArray),
+    MakeFlatType<Red::TweakDBID>(Red::ERTDBFlatType::TweakDBID, Red::ERTDBFlatType::TweakDBIDArray),
+    MakeFlatType<Red::Quaternion>(Red::ERTDBFlatType::Quaternion, Red::ERTDBFlatType::QuaternionArray),
+    MakeFlatType<Red::EulerAngles>(Red::ERTDBFlatType::EulerAngles, Red::ERTDBFlatType::EulerAnglesArray),
+    MakeFlatType<Red::Vector3>(Red::ERTDBFlatType::Vector3, Red::ERTDBFlatType::Vector3Array),
+    MakeFlatType<Red::Vector2>(Red::ERTDBFlatType::Vector2, Red::ERTDBFlatType::Vector2Array),
+    MakeFlatType<Red::Color>(Red::ERTDBFlatType::Color, Red::ERTDBFlatType::ColorArray),
+    MakeArrayFlatType<int>(Red::ERTDBFlatType::IntArray, Red::ERTDBFlatType::Int),
+    MakeArrayFlatType<float>(Red::ERTDBFlatType::FloatArray, Red::ERTDBFlatType::Float),
+    MakeArrayFlatType<bool>(Red::ERTDBFlatType::BoolArray, Red::ERTDBFlatType::Bool),
+    MakeArrayFlatType<Red::CString>(Red::ERTDBFlatType::StringArray, Red::ERTDBFlatType::String),
+    MakeArrayFlatType<Red::CName>(Red::ERTDBFlatType::CNameArray, Red::ERTDBFlatType::CName),
+    MakeArrayFlatType<Red::LocKeyWrapper>(Red::ERTDBFlatType::LocKeyArray, Red::ERTDBFlatType::LocKey),
+    MakeArrayFlatType<Red::ResourceAsyncReference<>>(Red::ERTDBFlatType::ResRefArray, Red::ERTDBFlatType::ResRef),
+    MakeArrayFlatType<Red::TweakDBID>(Red::ERTDBFlatType::TweakDBIDArray, Red::ERTDBFlatType::TweakDBID),
+    MakeArrayFlatType<Red::Quaternion>(Red::ERTDBFlatType::QuaternionArray, Red::ERTDBFlatType::Quaternion),
+    MakeArrayFlatType<Red::EulerAngles>(Red::ERTDBFlatType::EulerAnglesArray, Red::ERTDBFlatType::EulerAngles),
+    MakeArrayFlatType<Red::Vector3>(Red::ERTDBFlatType::Vector3Array, Red::ERTDBFlatType::Vector3),
+    MakeArrayFlatType<Red::Vector2>(Red::ERTDBFlatType::Vector2Array, Red::ERTDBFlatType::Vector2),
+    MakeArrayFlatType<Red::Color>(Red::ERTDBFlatType::ColorArray, Red::ERTDBFlatType::Color),
+};
+
+constexpr auto FlatTypeCount = std::size(FlatTypes);
+constexpr auto FlatTypeSlotBits = 6u;
+constexpr auto FlatTypeSlotCount = 1u << FlatTypeSlotBits;
+constexpr uint8_t EmptyFlatTypeSlot = 0xFF;
+
+constexpr uint32_t GetFlatTypeSlot(uint64_t aTypeName, uint64_t aMultiplier)
+{
+    return static_cast<uint32_t>(((aTypeName ^ (aTypeName >> 32)) * aMultiplier) >> (64 - FlatTypeSlotBits));
+}
+
+// Searches for a multiplier that maps every flat type to its own slot
+constexpr uint64_t FindFlatTypeMultiplier()
+{
+    for (uint64_t multiplier = 0x9E3779B97F4A7C15;; multiplier += 2)
+    {
+        bool used[FlatTypeSlotCount]{};
+        bool perfect = true;
+
+        for (const auto& flatType : FlatTypes)
+        {
+            auto& slot = used[GetFlatTypeSlot(flatType.name, multiplier)];
+
+            if (slot)
+            {
+                perfect = false;
+                break;
+            }
+
+            slot = true;
+        }
+
+        if (perfect)
+            return multiplier;
+    }
+}
+
+constexpr auto FlatTypeMultiplier = FindFlatTypeMultiplier();
+
+constexpr auto FlatTypeSlots = []() {
+    std::array<uint8_t, FlatTypeSlotCount> slots{};
+    slots.fill(EmptyFlatTypeSlot);
+
+    for (uint8_t i = 0; i < FlatTypeCount; ++i)
+    {
+        slots[GetFlatTypeSlot(FlatTypes[i].name, FlatTypeMultiplier)] = i;
+    }
+
+    return slots;
+}();
+
+static_assert(FlatTypeCount < EmptyFlatTypeSlot);
 }
 
 Red::TweakDBReflection::TweakDBReflection()
@@ -30,11 +145,20 @@ Red::TweakDBReflection::TweakDBReflection()
 Red::TweakDBReflection::TweakDBReflection(Red::TweakDB* aTweakDb)
     : m_tweakDb(aTweakDb)
     , m_rtti(Red::CRTTISystem::Get())
+    , m_frozen(nullptr)
+    , m_lazyTypes(0)
+    , m_lazyTime(0)
 {
 }
 
 const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(const Red::CClass* aType)
 {
+    if (aType)
+    {
+        if (const auto* recordInfo = FindFrozenRecordInfo(aType->GetName()))
+            return recordInfo;
+    }
+
     if (!IsRecordType(aType))
         return nullptr;
 
@@ -45,11 +169,14 @@ const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(const Red::C
             return iter->second.get();
     }
 
-    return CollectRecordInfo(aType).get();
+    return CollectRecordInfoOnRequest(aType);
 }
 
 const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(Red::CName aTypeName)
 {
+    if (const auto* recordInfo = FindFrozenRecordInfo(aTypeName))
+        return recordInfo;
+
     {
         std::shared_lock lockR(m_mutex);
         auto iter = m_resolved.find(aTypeName);
@@ -57,7 +184,127 @@ const Red::TweakDBRecordInfo* Red::TweakDBReflection::GetRecordInfo(Red::CName a
             return iter->second.get();
     }
 
-    return CollectRecordInfo(m_rtti->GetClass(aTypeName)).get();
+    return CollectRecordInfoOnRequest(m_rtti->GetClass(aTypeName));
+}
+
+const Red::TweakDBRecordInfo* Red::TweakDBReflection::FindFrozenRecordInfo(Red::CName aTypeName) const
+{
+    const auto* frozen = m_frozen.load(std::memory_order_acquire);
+
+    if (!frozen)
+        return nullptr;
+
+    auto iter = frozen->find(aTypeName);
+    if (iter == frozen->end())
+        return nullptr;
+
+    return iter->second.get();
+}
+
+const Red::TweakDBRecordInfo* Red::TweakDBReflection::CollectRecordInfoOnRequest(const Red::CClass* aType)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const auto recordInfo = CollectRecordInfo(aType);
+
+    if (recordInfo)
+    {
+        const auto endTime = std::chrono::steady_clock::now();
+
+        m_lazyTime += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        ++m_lazyTypes;
+    }
+
+    return recordInfo.get();
+}
+
+void Red::TweakDBReflection::WarmUp(uint32_t aWorkerCount)
+{
+    if (m_frozen.load(std::memory_order_acquire))
+        return;
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    static Red::CClass* s_baseRecordType = Red::CRTTISystem::Get()->GetClass(BaseRecordTypeName);
+
+    Red::DynArray<Red::CClass*> recordTypes;
+    m_rtti->GetDerivedClasses(s_baseRecordType, recordTypes);
+
+    Core::Vector<const Red::CClass*> pendingTypes;
+    pendingTypes.reserve(recordTypes.size);
+
+    {
+        std::shared_lock lockR(m_mutex);
+
+        for (const auto* recordType : recordTypes)
+        {
+            // The types restored from the schema cache are already complete
+            if (IsRecordType(recordType) && !m_resolved.contains(recordType->GetName()))
+            {
+                pendingTypes.push_back(recordType);
+            }
+        }
+    }
+
+    const auto maxWorkers = static_cast<uint32_t>(std::max<size_t>(pendingTypes.size(), 1));
+    const auto workerCount = std::clamp(aWorkerCount, 1u, maxWorkers);
+
+    std::atomic_size_t nextIndex = 0;
+    std::atomic_uint32_t warmedTypes = 0;
+    std::atomic_uint64_t warmUpWork = 0;
+
+    auto worker = [&]() {
+        const auto workerStartTime = std::chrono::steady_clock::now();
+
+        for (auto index = nextIndex++; index < pendingTypes.size(); index = nextIndex++)
+        {
+            if (CollectRecordInfo(pendingTypes[index]))
+            {
+                ++warmedTypes;
+            }
+        }
+
+        const auto workerEndTime = std::chrono::steady_clock::now();
+        warmUpWork += std::chrono::duration_cast<std::chrono::nanoseconds>(workerEndTime - workerStartTime).count();
+    };
+
+    Core::Vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+
+    for (auto i = 1u; i < workerCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    {
+        std::unique_lock lockRW(m_mutex);
+
+        // The copy shares the record infos, so the pointers handed out before stay valid
+        m_frozenStorage = Core::MakeUnique<const RecordInfoMap>(m_resolved);
+        m_frozen.store(m_frozenStorage.get(), std::memory_order_release);
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+
+    m_warmUpStats.warmedTypes = warmedTypes;
+    m_warmUpStats.warmUpWork = warmUpWork;
+    m_warmUpStats.warmUpTime = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+}
+
+Red::TweakDBReflection::ResolveStats Red::TweakDBReflection::GetResolveStats() const
+{
+    auto stats = m_warmUpStats;
+    stats.lazyTypes = m_lazyTypes;
+    stats.lazyTime = m_lazyTime;
+
+    return stats;
 }
 
 Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInfo(
@@ -209,56 +456,279 @@ Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::CollectRecordInf
         recordInfo->props[propInfo->name] = propInfo;
     }
 
+    ApplyExtraFlats(recordInfo.get(), aType);
+
+    for (auto& [_, propInfo] : recordInfo->props)
     {
-        auto extraFlatsIt = s_extraFlats.find(aType->name);
-        if (extraFlatsIt != s_extraFlats.end())
+        if (propInfo->dataOffset)
         {
-            recordInfo->extraFlats = true;
+            propInfo->defaultValue = ResolveDefaultValue(aType, propInfo->appendix);
+        }
+    }
 
-            for (const auto& extraFlat : extraFlatsIt.value())
-            {
-                auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
-                propInfo->name = Red::CName(extraFlat.appendix.c_str() + 1);
-                propInfo->appendix = extraFlat.appendix;
-                propInfo->type = m_rtti->GetType(extraFlat.typeName);
+    {
+        std::unique_lock lockRW(m_mutex);
+        BuildFlatTemplates(recordInfo.get());
+        m_resolved.insert({ recordInfo->name, recordInfo });
+    }
 
-                if (propInfo->type->GetType() == Red::ERTTIType::Array)
-                {
-                    const auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(propInfo->type);
-                    propInfo->elementType = arrayType->innerType;
-                    propInfo->isArray = true;
-                }
+    return recordInfo;
+}
 
-                if (!extraFlat.foreignTypeName.IsNone())
-                {
-                    propInfo->foreignType = m_rtti->GetClass(extraFlat.foreignTypeName);
-                    propInfo->isForeignKey = true;
-                }
+void Red::TweakDBReflection::ApplyExtraFlats(Red::TweakDBRecordInfo* aRecordInfo, const Red::CClass* aType)
+{
+    auto extraFlatsIt = s_extraFlats.find(aType->name);
+    if (extraFlatsIt == s_extraFlats.end())
+        return;
 
-                propInfo->dataOffset = 0;
-                propInfo->defaultValue = -1;
+    aRecordInfo->extraFlats = true;
 
-                recordInfo->props[propInfo->name] = propInfo;
+    for (const auto& extraFlat : extraFlatsIt.value())
+    {
+        auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
+        propInfo->name = Red::CName(extraFlat.appendix.c_str() + 1);
+        propInfo->appendix = extraFlat.appendix;
+        propInfo->type = m_rtti->GetType(extraFlat.typeName);
+
+        if (propInfo->type->GetType() == Red::ERTTIType::Array)
+        {
+            const auto arrayType = reinterpret_cast<const Red::CRTTIArrayType*>(propInfo->type);
+            propInfo->elementType = arrayType->innerType;
+            propInfo->isArray = true;
+        }
+
+        if (!extraFlat.foreignTypeName.IsNone())
+        {
+            propInfo->foreignType = m_rtti->GetClass(extraFlat.foreignTypeName);
+            propInfo->isForeignKey = true;
+        }
+
+        propInfo->dataOffset = 0;
+        propInfo->defaultValue = -1;
+
+        aRecordInfo->props[propInfo->name] = propInfo;
+    }
+}
+
+Core::Vector<Red::TweakDBRecordSchema> Red::TweakDBReflection::ExportSchema()
+{
+    std::shared_lock lockR(m_mutex);
+
+    Core::Vector<Red::TweakDBRecordSchema> schema;
+    schema.reserve(m_resolved.size());
+
+    for (const auto& [_, recordInfo] : m_resolved)
+    {
+        auto& recordSchema = schema.emplace_back();
+        recordSchema.typeName = recordInfo->name;
+        recordSchema.parentName = recordInfo->type->parent ? recordInfo->type->parent->GetName() : Red::CName();
+        recordSchema.typeHash = recordInfo->typeHash;
+        recordSchema.funcCount = recordInfo->type->funcs.size;
+
+        for (const auto& [__, propInfo] : recordInfo->props)
+        {
+            // Extra flats can change between sessions, so they're always taken from the metadata
+            if (!propInfo->dataOffset)
+                continue;
+
+            auto& propSchema = recordSchema.props.emplace_back();
+            propSchema.typeName = propInfo->type->GetName();
+            propSchema.foreignTypeName = propInfo->foreignType ? propInfo->foreignType->GetName() : Red::CName();
+            propSchema.appendix = propInfo->appendix;
+            propSchema.dataOffset = static_cast<uint32_t>(propInfo->dataOffset);
+            propSchema.defaultId = GetDefaultFlatId(recordInfo->type, propInfo->appendix);
+        }
+
+        // The order of the properties doesn't depend on the hashing
+        std::sort(recordSchema.props.begin(), recordSchema.props.end(), [](const auto& aLeft, const auto& aRight) {
+            return aLeft.dataOffset < aRight.dataOffset;
+        });
+    }
+
+    return schema;
+}
+
+uint32_t Red::TweakDBReflection::ImportSchema(std::span<const Red::TweakDBRecordSchema> aSchema)
+{
+    Core::Vector<Core::SharedPtr<Red::TweakDBRecordInfo>> recordInfos;
+    recordInfos.reserve(aSchema.size());
+
+    {
+        std::shared_lock<Red::SharedMutex> flatLockR(m_tweakDb->mutex00);
+
+        for (const auto& recordSchema : aSchema)
+        {
+            if (auto recordInfo = ImportRecordInfo(recordSchema))
+            {
+                recordInfos.push_back(std::move(recordInfo));
             }
         }
     }
 
-    for (auto& [_, propInfo] : recordInfo->props)
+    for (auto& recordInfo : recordInfos)
     {
-        if (propInfo->dataOffset)
+        // Extra flats of the parent types are inherited the same way the properties are
+        Core::Vector<const Red::CClass*> types;
+        for (auto* type = recordInfo->type; IsRecordType(type); type = type->parent)
         {
-            propInfo->defaultValue = ResolveDefaultValue(aType, propInfo->appendix);
+            types.push_back(type);
+        }
+
+        for (auto it = types.rbegin(); it != types.rend(); ++it)
+        {
+            ApplyExtraFlats(recordInfo.get(), *it);
         }
     }
 
+    std::unique_lock lockRW(m_mutex);
+
+    uint32_t imported = 0;
+
+    for (auto& recordInfo : recordInfos)
     {
-        std::unique_lock lockRW(m_mutex);
-        m_resolved.insert({ recordInfo->name, recordInfo });
+        if (m_resolved.contains(recordInfo->name))
+            continue;
+
+        BuildFlatTemplates(recordInfo.get());
+        m_resolved.insert({recordInfo->name, std::move(recordInfo)});
+        ++imported;
+    }
+
+    return imported;
+}
+
+// Must be called with the flats locked
+Core::SharedPtr<Red::TweakDBRecordInfo> Red::TweakDBReflection::ImportRecordInfo(
+    const Red::TweakDBRecordSchema& aSchema)
+{
+    const auto* type = m_rtti->GetClass(aSchema.typeName);
+
+    if (!IsRecordType(type) || type->funcs.size != aSchema.funcCount)
+        return nullptr;
+
+    if ((type->parent ? type->parent->GetName() : Red::CName()) != aSchema.parentName)
+        return nullptr;
+
+    auto recordInfo = Red::MakeInstance<Red::TweakDBRecordInfo>();
+    recordInfo->name = type->name;
+    recordInfo->type = type;
+    recordInfo->typeHash = aSchema.typeHash;
+    recordInfo->shortName = GetRecordShortName(type->name);
+
+    if (IsRecordType(type->parent))
+    {
+        recordInfo->parent = type->parent;
+    }
+
+    for (const auto& propSchema : aSchema.props)
+    {
+        if (propSchema.appendix.size() < 2 || !propSchema.dataOffset)
+            return nullptr;
+
+        auto propInfo = Red::MakeInstance<Red::TweakDBPropertyInfo>();
+        propInfo->name = Red::CName(propSchema.appendix.c_str() + 1);
+        propInfo->appendix = propSchema.appendix;
+        propInfo->dataOffset = propSchema.dataOffset;
+        propInfo->type = m_rtti->GetType(propSchema.typeName);
+
+        if (!propInfo->type)
+            return nullptr;
+
+        if (propInfo->type->GetType() == Red::ERTTIType::Array)
+        {
+            propInfo->elementType = GetElementType(propInfo->type);
+            propInfo->isArray = true;
+        }
+
+        if (!propSchema.foreignTypeName.IsNone())
+        {
+            propInfo->foreignType = m_rtti->GetClass(propSchema.foreignTypeName);
+            propInfo->isForeignKey = true;
+
+            if (!propInfo->foreignType)
+                return nullptr;
+        }
+
+        auto defaultFlat = m_tweakDb->flats.Find(propSchema.defaultId);
+        propInfo->defaultValue = defaultFlat != m_tweakDb->flats.End() ? defaultFlat->ToTDBOffset() : -1;
+
+        recordInfo->props[propInfo->name] = propInfo;
     }
 
     return recordInfo;
 }
 
+void Red::TweakDBReflection::BuildFlatTemplates(Red::TweakDBRecordInfo* aRecordInfo)
+{
+    aRecordInfo->flats.clear();
+    aRecordInfo->flats.reserve(aRecordInfo->props.size());
+
+    for (const auto& [_, propInfo] : aRecordInfo->props)
+    {
+        auto& flatTemplate = aRecordInfo->flats.emplace_back();
+        flatTemplate.propInfo = propInfo.get();
+        flatTemplate.appendixHash = HashAppendix(0, propInfo->appendix);
+        flatTemplate.appendixLength = static_cast<uint8_t>(propInfo->appendix.size());
+        flatTemplate.defaultValue = propInfo->defaultValue;
+        flatTemplate.isDataProp = propInfo->dataOffset != 0;
+        flatTemplate.shift = nullptr;
+
+        std::array<uint32_t, 32> columns{};
+        for (uint32_t bit = 0; bit < 32; ++bit)
+        {
+            columns[bit] = HashAppendix(1u << bit, propInfo->appendix) ^ flatTemplate.appendixHash;
+        }
+
+        flatTemplate.shift = GetHashShift(columns);
+
+        // Keep the regular hashing if the derived function doesn't match it
+        for (const auto seed : HashProbeSeeds)
+        {
+            if ((flatTemplate.shift->Apply(seed) ^ flatTemplate.appendixHash) != HashAppendix(seed, propInfo->appendix))
+            {
+                flatTemplate.shift = nullptr;
+                break;
+            }
+        }
+    }
+
+    // Properties sharing the lookup tables are processed one after another
+    std::sort(aRecordInfo->flats.begin(), aRecordInfo->flats.end(), [](const auto& aLeft, const auto& aRight) {
+        return aLeft.shift < aRight.shift;
+    });
+}
+
+const Red::TweakDBHashShift* Red::TweakDBReflection::GetHashShift(const std::array<uint32_t, 32>& aColumns)
+{
+    // With a CRC the columns only depend on the appendix length, so there are only a few distinct tables
+    for (const auto& hashShift : m_hashShifts)
+    {
+        if (hashShift->columns == aColumns)
+            return hashShift.get();
+    }
+
+    auto hashShift = Core::MakeUnique<Red::TweakDBHashShift>();
+    hashShift->columns = aColumns;
+
+    for (uint32_t byte = 0; byte < 4; ++byte)
+    {
+        for (uint32_t value = 0; value < 256; ++value)
+        {
+            uint32_t result = 0;
+            for (uint32_t bit = 0; bit < 8; ++bit)
+            {
+                if (value & (1u << bit))
+                {
+                    result ^= aColumns[byte * 8 + bit];
+                }
+            }
+            hashShift->lookup[byte][value] = result;
+        }
+    }
+
+    return m_hashShifts.emplace_back(std::move(hashShift)).get();
+}
+
 Red::TweakDBID Red::TweakDBReflection::GetRecordSampleId(const Red::CClass* aType)
 {
     std::shared_lock<Red::SharedMutex> recordLockR(m_tweakDb->mutex01);
@@ -298,6 +768,20 @@ std::string Red::TweakDBReflection::ResolvePropertyName(Red::TweakDBID aSampleId
 }
 
 int32_t Red::TweakDBReflection::ResolveDefaultValue(const Red::CClass* aType, const std::string& aPropName)
+{
+    const auto defaultFlatId = GetDefaultFlatId(aType, aPropName);
+
+    std::shared_lock<Red::SharedMutex> flatLockR(m_tweakDb->mutex00);
+
+    auto defaultFlat = m_tweakDb->flats.Find(defaultFlatId);
+
+    if (defaultFlat == m_tweakDb->flats.End())
+        return -1;
+
+    return defaultFlat->ToTDBOffset();
+}
+
+Red::TweakDBID Red::TweakDBReflection::GetDefaultFlatId(const Red::CClass* aType, const std::string& aPropName)
 {
     std::string defaultFlatName = TweakSource::SchemaPackage;
     defaultFlatName.append(NameSeparator);
@@ -310,16 +794,7 @@ int32_t Red::TweakDBReflection::ResolveDefaultValue(const Red::CClass* aType, co
 
     defaultFlatName.append(aPropName);
 
-    const auto defaultFlatId = Red::TweakDBID(defaultFlatName);
-
-    std::shared_lock<Red::SharedMutex> flatLockR(m_tweakDb->mutex00);
-
-    auto defaultFlat = m_tweakDb->flats.Find(defaultFlatId);
-
-    if (defaultFlat == m_tweakDb->flats.End())
-        return -1;
-
-    return defaultFlat->ToTDBOffset();
+    return Red::TweakDBID(defaultFlatName);
 }
 
 const Red::CBaseRTTIType* Red::TweakDBReflection::GetFlatType(Red::CName aTypeName)
@@ -372,40 +847,19 @@ Red::CBaseRTTIType* Red::TweakDBReflection::GetElementType(const Red::CBaseRTTIT
     return reinterpret_cast<const Red::CRTTIBaseArrayType*>(aType)->innerType;
 }
 
+const Red::TweakDBFlatTypeInfo* Red::TweakDBReflection::GetFlatTypeInfo(Red::CName aTypeName)
+{
+    const auto index = FlatTypeSlots[GetFlatTypeSlot(aTypeName.hash, FlatTypeMultiplier)];
+
+    if (index == EmptyFlatTypeSlot || FlatTypes[index].name != aTypeName.hash)
+        return nullptr;
+
+    return &FlatTypes[index];
+}
+
 bool Red::TweakDBReflection::IsFlatType(Red::CName aTypeName)
 {
-    switch (aTypeName)
-    {
-    case Red::ERTDBFlatType::Int:
-    case Red::ERTDBFlatType::Float:
-    case Red::ERTDBFlatType::Bool:
-    case Red::ERTDBFlatType::String:
-    case Red::ERTDBFlatType::CName:
-    case Red::ERTDBFlatType::LocKey:
-    case Red::ERTDBFlatType::ResRef:
-    case Red::ERTDBFlatType::TweakDBID:
-    case Red::ERTDBFlatType::Quaternion:
-    case Red::ERTDBFlatType::EulerAngles:
-    case Red::ERTDBFlatType::Vector3:
-    case Red::ERTDBFlatType::Vector2:
-    case Red::ERTDBFlatType::Color:
-    case Red::ERTDBFlatType::IntArray:
-    case Red::ERTDBFlatType::FloatArray:
-    case Red::ERTDBFlatType::BoolArray:
-    case Red::ERTDBFlatType::StringArray:
-    case Red::ERTDBFlatType::CNameArray:
-    case Red::ERTDBFlatType::LocKeyArray:
-    case Red::ERTDBFlatType::ResRefArray:
-    case Red::ERTDBFlatType::TweakDBIDArray:
-    case Red::ERTDBFlatType::QuaternionArray:
-    case Red::ERTDBFlatType::EulerAnglesArray:
-    case Red::ERTDBFlatType::Vector3Array:
-    case Red::ERTDBFlatType::Vector2Array:
-    case Red::ERTDBFlatType::ColorArray:
-        return true;
-    default:
-        return false;
-    }
+    return GetFlatTypeInfo(aTypeName) != nullptr;
 }
 
 bool Red::TweakDBReflection::IsFlatType(const Red::CBaseRTTIType* aType)
@@ -427,25 +881,8 @@ bool Red::TweakDBReflection::IsRecordType(const Red::CClass* aType)
 
 bool Red::TweakDBReflection::IsArrayType(Red::CName aTypeName)
 {
-    switch (aTypeName)
-    {
-    case Red::ERTDBFlatType::IntArray:
-    case Red::ERTDBFlatType::FloatArray:
-    case Red::ERTDBFlatType::BoolArray:
-    case Red::ERTDBFlatType::StringArray:
-    case Red::ERTDBFlatType::CNameArray:
-    case Red::ERTDBFlatType::LocKeyArray:
-    case Red::ERTDBFlatType::ResRefArray:
-    case Red::ERTDBFlatType::TweakDBIDArray:
-    case Red::ERTDBFlatType::QuaternionArray:
-    case Red::ERTDBFlatType::EulerAnglesArray:
-    case Red::ERTDBFlatType::Vector3Array:
-    case Red::ERTDBFlatType::Vector2Array:
-    case Red::ERTDBFlatType::ColorArray:
-        return true;
-    default:
-        return false;
-    }
+    const auto* typeInfo = GetFlatTypeInfo(aTypeName);
+    return typeInfo && typeInfo->isArray;
 }
 
 bool Red::TweakDBReflection::IsArrayType(const Red::CBaseRTTIType* aType)
@@ -495,24 +932,12 @@ bool Red::TweakDBReflection::IsResRefTokenArray(const Red::CBaseRTTIType* aType)
 
 Red::CName Red::TweakDBReflection::GetArrayTypeName(Red::CName aTypeName)
 {
-    switch (aTypeName)
-    {
-    case Red::ERTDBFlatType::Int: return Red::ERTDBFlatType::IntArray;
-    case Red::ERTDBFlatType::Float: return Red::ERTDBFlatType::FloatArray;
-    case Red::ERTDBFlatType::Bool: return Red::ERTDBFlatType::BoolArray;
-    case Red::ERTDBFlatType::String: return Red::ERTDBFlatType::StringArray;
-    case Red::ERTDBFlatType::CName: return Red::ERTDBFlatType::CNameArray;
-    case Red::ERTDBFlatType::LocKey: return Red::ERTDBFlatType::LocKeyArray;
-    case Red::ERTDBFlatType::ResRef: return Red::ERTDBFlatType::ResRefArray;
-    case Red::ERTDBFlatType::TweakDBID: return Red::ERTDBFlatType::TweakDBIDArray;
-    case Red::ERTDBFlatType::Quaternion: return Red::ERTDBFlatType::QuaternionArray;
-    case Red::ERTDBFlatType::EulerAngles: return Red::ERTDBFlatType::EulerAnglesArray;
-    case Red::ERTDBFlatType::Vector3: return Red::ERTDBFlatType::Vector3Array;
-    case Red::ERTDBFlatType::Vector2: return Red::ERTDBFlatType::Vector2Array;
-    case Red::ERTDBFlatType::Color: return Red::ERTDBFlatType::ColorArray;
-    }
+    const auto* typeInfo = GetFlatTypeInfo(aTypeName);
 
-    return {};
+    if (!typeInfo || typeInfo->isArray)
+        return {};
+
+    return typeInfo->arrayName;
 }
 
 Red::CName Red::TweakDBReflection::GetArrayTypeName(const Red::CBaseRTTIType* aType)
@@ -525,24 +950,12 @@ Red::CName Red::TweakDBReflection::GetArrayTypeName(const Red::CBaseRTTIType* aT
 
 Red::CName Red::TweakDBReflection::GetElementTypeName(Red::CName aTypeName)
 {
-    switch (aTypeName)
-    {
-    case Red::ERTDBFlatType::IntArray: return Red::ERTDBFlatType::Int;
-    case Red::ERTDBFlatType::FloatArray: return Red::ERTDBFlatType::Float;
-    case Red::ERTDBFlatType::BoolArray: return Red::ERTDBFlatType::Bool;
-    case Red::ERTDBFlatType::StringArray: return Red::ERTDBFlatType::String;
-    case Red::ERTDBFlatType::CNameArray: return Red::ERTDBFlatType::CName;
-    case Red::ERTDBFlatType::TweakDBIDArray: return Red::ERTDBFlatType::TweakDBID;
-    case Red::ERTDBFlatType::LocKeyArray: return Red::ERTDBFlatType::LocKey;
-    case Red::ERTDBFlatType::ResRefArray: return Red::ERTDBFlatType::ResRef;
-    case Red::ERTDBFlatType::QuaternionArray: return Red::ERTDBFlatType::Quaternion;
-    case Red::ERTDBFlatType::EulerAnglesArray: return Red::ERTDBFlatType::EulerAngles;
-    case Red::ERTDBFlatType::Vector3Array: return Red::ERTDBFlatType::Vector3;
-    case Red::ERTDBFlatType::Vector2Array: return Red::ERTDBFlatType::Vector2;
-    case Red::ERTDBFlatType::ColorArray: return Red::ERTDBFlatType::Color;
-    }
+    const auto* typeInfo = GetFlatTypeInfo(aTypeName);
 
-    return {};
+    if (!typeInfo || !typeInfo->isArray)
+        return {};
+
+    return typeInfo->elementName;
 }
 
 Red::CName Red::TweakDBReflection::GetElementTypeName(const Red::CBaseRTTIType* aType)
@@ -594,37 +1007,12 @@ std::string Red::TweakDBReflection::GetRecordShortName(const char* aName)
 
 Red::InstancePtr<> Red::TweakDBReflection::Construct(Red::CName aTypeName)
 {
-    switch (aTypeName)
-    {
-    case Red::ERTDBFlatType::Int: return Red::MakeInstance<int>();
-    case Red::ERTDBFlatType::Float: return Red::MakeInstance<float>();
-    case Red::ERTDBFlatType::Bool: return Red::MakeInstance<bool>();
-    case Red::ERTDBFlatType::String: return Red::MakeInstance<Red::CString>();
-    case Red::ERTDBFlatType::CName: return Red::MakeInstance<Red::CName>();
-    case Red::ERTDBFlatType::LocKey: return Red::MakeInstance<Red::LocKeyWrapper>();
-    case Red::ERTDBFlatType::ResRef: return Red::MakeInstance<Red::ResourceAsyncReference<>>();
-    case Red::ERTDBFlatType::TweakDBID: return Red::MakeInstance<Red::TweakDBID>();
-    case Red::ERTDBFlatType::Quaternion: return Red::MakeInstance<Red::Quaternion>();
-    case Red::ERTDBFlatType::EulerAngles: return Red::MakeInstance<Red::EulerAngles>();
-    case Red::ERTDBFlatType::Vector3: return Red::MakeInstance<Red::Vector3>();
-    case Red::ERTDBFlatType::Vector2: return Red::MakeInstance<Red::Vector2>();
-    case Red::ERTDBFlatType::Color: return Red::MakeInstance<Red::Color>();
-    case Red::ERTDBFlatType::IntArray: return Red::MakeInstance<Red::DynArray<int>>();
-    case Red::ERTDBFlatType::FloatArray: return Red::MakeInstance<Red::DynArray<float>>();
-    case Red::ERTDBFlatType::BoolArray: return Red::MakeInstance<Red::DynArray<bool>>();
-    case Red::ERTDBFlatType::StringArray: return Red::MakeInstance<Red::DynArray<Red::CString>>();
-    case Red::ERTDBFlatType::CNameArray: return Red::MakeInstance<Red::DynArray<Red::CName>>();
-    case Red::ERTDBFlatType::LocKeyArray: return Red::MakeInstance<Red::DynArray<Red::LocKeyWrapper>>();
-    case Red::ERTDBFlatType::ResRefArray: return Red::MakeInstance<Red::DynArray<Red::ResourceAsyncReference<>>>();
-    case Red::ERTDBFlatType::TweakDBIDArray: return Red::MakeInstance<Red::DynArray<Red::TweakDBID>>();
-    case Red::ERTDBFlatType::QuaternionArray: return Red::MakeInstance<Red::DynArray<Red::Quaternion>>();
-    case Red::ERTDBFlatType::EulerAnglesArray: return Red::MakeInstance<Red::DynArray<Red::EulerAngles>>();
-    case Red::ERTDBFlatType::Vector3Array: return Red::MakeInstance<Red::DynArray<Red::Vector3>>();
-    case Red::ERTDBFlatType::Vector2Array: return Red::MakeInstance<Red::DynArray<Red::Vector2>>();
-    case Red::ERTDBFlatType::ColorArray: return Red::MakeInstance<Red::DynArray<Red::Color>>();
-    }
+    const auto* typeInfo = GetFlatTypeInfo(aTypeName);
+
+    if (!typeInfo)
+        return {};
 
-    return {};
+    return typeInfo->construct();
 }
 
 Red::InstancePtr<> Red::TweakDBReflection::Construct(const Red::CBaseRTTIType* aType)
@@ -641,35 +1029,72 @@ void Red::TweakDBReflection::RegisterExtraFlat(Red::CName aRecordType, const std
     s_extraFlats[aRecordType].push_back({aPropType, aForeignType, NameSeparator + aPropName});
 }
 
-void Red::TweakDBReflection::RegisterDescendants(Red::TweakDBID aParentId,
-                                                const Core::Set<Red::TweakDBID>& aDescendantIds)
+void Red::TweakDBReflection::RegisterExtraFlats(Red::CName aRecordType,
+                                                std::span<const Red::TweakDBExtraFlat> aExtraFlats)
 {
-    s_descendantMap[aParentId].insert(aDescendantIds.begin(), aDescendantIds.end());
+    auto& extraFlats = s_extraFlats[aRecordType];
+    extraFlats.insert(extraFlats.end(), aExtraFlats.begin(), aExtraFlats.end());
+}
+
+void Red::TweakDBReflection::RegisterInheritance(Core::SharedPtr<Red::TweakDBInheritance> aInheritance)
+{
+    s_inheritance = std::move(aInheritance);
+}
 
-    for (const auto& descendantId : aDescendantIds)
+void Red::TweakDBReflection::DetachInheritance()
+{
+    if (s_inheritance)
     {
-        s_parentMap[descendantId] = aParentId;
+        s_inheritance->Detach();
+    }
+}
+
+void Red::TweakDBReflection::RefreshDefaultValues()
+{
+    // The frozen table shares the record infos, so updating them in place covers both tables
+    std::unique_lock lockRW(m_mutex);
+
+    for (const auto& [_, recordInfo] : m_resolved)
+    {
+        for (const auto& [__, propInfo] : recordInfo->props)
+        {
+            if (propInfo->dataOffset)
+            {
+                propInfo->defaultValue = ResolveDefaultValue(recordInfo->type, propInfo->appendix);
+            }
+        }
+
+        for (auto& flatTemplate : recordInfo->flats)
+        {
+            flatTemplate.defaultValue = flatTemplate.propInfo->defaultValue;
+        }
     }
 }
 
 bool Red::TweakDBReflection::IsOriginalRecord(Red::TweakDBID aRecordId)
 {
-    return s_parentMap.contains(aRecordId);
+    return s_inheritance && s_inheritance->IsDescendant(aRecordId);
 }
 
 bool Red::TweakDBReflection::IsOriginalBaseRecord(Red::TweakDBID aParentId)
 {
-    return s_descendantMap.contains(aParentId);
+    return s_inheritance && s_inheritance->IsParent(aParentId);
 }
 
 Red::TweakDBID Red::TweakDBReflection::GetOriginalParent(Red::TweakDBID aRecordId)
 {
-    return s_parentMap[aRecordId];
+    if (!s_inheritance)
+        return {};
+
+    return s_inheritance->GetParent(aRecordId);
 }
 
-const Core::Set<Red::TweakDBID>& Red::TweakDBReflection::GetOriginalDescendants(Red::TweakDBID aSourceId)
+std::span<const Red::TweakDBID> Red::TweakDBReflection::GetOriginalDescendants(Red::TweakDBID aSourceId)
 {
-    return s_descendantMap[aSourceId];
+    if (!s_inheritance)
+        return {};
+
+    return s_inheritance->GetDescendants(aSourceId);
 }
 
 std::string Red::TweakDBReflection::ToString(Red::TweakDBID aID)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Red/TweakDB/Alias.hpp"
+#include "Red/TweakDB/Inheritance.hpp"
 
 namespace Red
 {
@@ -37,6 +38,19 @@ enum : uint64_t
 };
 }
 
+// Static description of a flat type.
+struct TweakDBFlatTypeInfo
+{
+    uint64_t name;
+    uint64_t elementName; // Only for arrays
+    uint64_t arrayName; // Only for elements
+    uint32_t size;
+    uint32_t elementSize; // Only for arrays
+    bool isArray;
+    bool isString; // The value or the elements are strings, which are compared by content
+    Red::InstancePtr<> (*construct)();
+};
+
 struct TweakDBPropertyInfo
 {
     Red::CName name;
@@ -50,12 +64,50 @@ struct TweakDBPropertyInfo
     int32_t defaultValue; // Offset of the default value in the buffer
 };
 
+// Linear part of the ID hash when an appendix of a certain length is added to a seed.
+// The hash is a CRC, so the result for any seed is a combination of the results for single bits,
+// which are precomputed per byte of the seed.
+struct TweakDBHashShift
+{
+    std::array<uint32_t, 32> columns;
+    std::array<std::array<uint32_t, 256>, 4> lookup;
+
+    [[nodiscard]] uint32_t Apply(uint32_t aSeed) const
+    {
+        return lookup[0][aSeed & 0xFF] ^ lookup[1][(aSeed >> 8) & 0xFF] ^ lookup[2][(aSeed >> 16) & 0xFF] ^
+               lookup[3][aSeed >> 24];
+    }
+};
+
+// Precomputed flat of a record property, the ID for any record is derived without hashing the appendix.
+struct TweakDBFlatTemplate
+{
+    const Red::TweakDBHashShift* shift; // Null if the hash can't be derived, the appendix is hashed then
+    const Red::TweakDBPropertyInfo* propInfo;
+    uint32_t appendixHash; // Hash of the appendix for a zero seed
+    int32_t defaultValue;
+    uint8_t appendixLength;
+    bool isDataProp; // The property is stored in the record instance
+
+    [[nodiscard]] Red::TweakDBID GetFlatId(Red::TweakDBID aRecordId) const
+    {
+        if (!shift)
+            return Red::TweakDBID(aRecordId, propInfo->appendix);
+
+        Red::TweakDBID flatId;
+        flatId.name.hash = shift->Apply(aRecordId.name.hash) ^ appendixHash;
+        flatId.name.length = aRecordId.name.length + appendixLength;
+        return flatId;
+    }
+};
+
 struct TweakDBRecordInfo
 {
     Red::CName name;
     const Red::CClass* type;
     const Red::CClass* parent;
     Core::Map<Red::CName, Core::SharedPtr<Red::TweakDBPropertyInfo>> props;
+    Core::Vector<Red::TweakDBFlatTemplate> flats; // Same properties as a flat array
     bool extraFlats;
     std::string shortName;
     uint32_t typeHash;
@@ -67,9 +119,45 @@ struct TweakDBRecordInfo
     }
 };
 
+struct TweakDBExtraFlat
+{
+    Red::CName typeName;
+    Red::CName foreignTypeName;
+    std::string appendix; // Property name with the leading separator
+};
+
+// Description of a record type that can be restored without probing the database.
+// Extra flats are not part of the schema, they're applied again when the schema is imported.
+struct TweakDBRecordSchema
+{
+    struct Property
+    {
+        Red::CName typeName;
+        Red::CName foreignTypeName;
+        std::string appendix;
+        uint32_t dataOffset;
+        Red::TweakDBID defaultId; // ID of the flat holding the default value
+    };
+
+    Red::CName typeName;
+    Red::CName parentName;
+    uint32_t typeHash;
+    uint32_t funcCount; // Used to detect changed types
+    Core::Vector<Property> props;
+};
+
 class TweakDBReflection
 {
 public:
+    struct ResolveStats
+    {
+        uint32_t warmedTypes = 0; // types collected by the warm-up
+        uint32_t lazyTypes = 0; // types collected on first request
+        uint64_t warmUpTime = 0; // ns, wall time of the warm-up
+        uint64_t warmUpWork = 0; // ns, collection time of all warm-up workers
+        uint64_t lazyTime = 0; // ns, spent by the requesters
+    };
+
     TweakDBReflection();
     explicit TweakDBReflection(Red::TweakDB* aTweakDb);
 
@@ -86,6 +174,9 @@ public:
     Red::CBaseRTTIType* GetElementType(Red::CName aTypeName);
     Red::CBaseRTTIType* GetElementType(const Red::CBaseRTTIType* aType);
 
+    // Returns null if the type is not a flat type.
+    static const Red::TweakDBFlatTypeInfo* GetFlatTypeInfo(Red::CName aTypeName);
+
     bool IsFlatType(Red::CName aTypeName);
     bool IsFlatType(const Red::CBaseRTTIType* aType);
 
@@ -125,42 +216,65 @@ public:
     bool IsOriginalRecord(Red::TweakDBID aRecordId);
     bool IsOriginalBaseRecord(Red::TweakDBID aParentId);
     Red::TweakDBID GetOriginalParent(Red::TweakDBID aRecordId);
-    const Core::Set<Red::TweakDBID>& GetOriginalDescendants(Red::TweakDBID aSourceId);
+    std::span<const Red::TweakDBID> GetOriginalDescendants(Red::TweakDBID aSourceId);
 
     void RegisterExtraFlat(Red::CName aRecordType, const std::string& aPropName, Red::CName aPropType,
                            Red::CName aForeignType);
-    void RegisterDescendants(Red::TweakDBID aParentId, const Core::Set<Red::TweakDBID>& aDescendantIds);
+    void RegisterExtraFlats(Red::CName aRecordType, std::span<const Red::TweakDBExtraFlat> aExtraFlats);
+    void RegisterInheritance(Core::SharedPtr<Red::TweakDBInheritance> aInheritance);
+    void DetachInheritance();
+
+    // Resolves the default values of the known record types again after the flat offsets changed.
+    // The record infos are changed in place and frozen lookups don't lock,
+    // so the caller must ensure that nothing reads the default values at the same time.
+    void RefreshDefaultValues();
+
+    // Collects all record types in parallel and freezes the result into a table that's read without locking.
+    // The types that can't be resolved at this point are still collected on first request.
+    void WarmUp(uint32_t aWorkerCount);
+
+    [[nodiscard]] ResolveStats GetResolveStats() const;
+
+    // Describes all record types resolved so far.
+    Core::Vector<Red::TweakDBRecordSchema> ExportSchema();
+
+    // Restores record types from the schema and returns the number of imported types.
+    // Types that don't match the current runtime are skipped and will be discovered when requested.
+    uint32_t ImportSchema(std::span<const Red::TweakDBRecordSchema> aSchema);
 
     std::string ToString(Red::TweakDBID aID);
 
     Red::TweakDB* GetTweakDB();
 
 private:
-    struct ExtraFlat
-    {
-        Red::CName typeName;
-        Red::CName foreignTypeName;
-        std::string appendix;
-    };
-
-    using ParentMap = Core::Map<Red::TweakDBID, Red::TweakDBID>;
-    using DescendantMap = Core::Map<Red::TweakDBID, Core::Set<Red::TweakDBID>>;
-    using ExtraFlatMap = Core::Map<Red::CName, Core::Vector<ExtraFlat>>;
+    using ExtraFlatMap = Core::Map<Red::CName, Core::Vector<Red::TweakDBExtraFlat>>;
     using RecordInfoMap = Core::Map<Red::CName, Core::SharedPtr<Red::TweakDBRecordInfo>>;
 
     Core::SharedPtr<Red::TweakDBRecordInfo> CollectRecordInfo(const Red::CClass* aType, Red::TweakDBID aSampleId = {});
+    const Red::TweakDBRecordInfo* CollectRecordInfoOnRequest(const Red::CClass* aType);
+    const Red::TweakDBRecordInfo* FindFrozenRecordInfo(Red::CName aTypeName) const;
     Red::TweakDBID GetRecordSampleId(const Red::CClass* aType);
     uint32_t GetRecordTypeHash(const Red::CClass* aType);
     std::string ResolvePropertyName(Red::TweakDBID aSampleId, Red::CName aGetterName);
     int32_t ResolveDefaultValue(const Red::CClass* aType, const std::string& aPropName);
+    Red::TweakDBID GetDefaultFlatId(const Red::CClass* aType, const std::string& aPropName);
+    void ApplyExtraFlats(Red::TweakDBRecordInfo* aRecordInfo, const Red::CClass* aType);
+    Core::SharedPtr<Red::TweakDBRecordInfo> ImportRecordInfo(const Red::TweakDBRecordSchema& aSchema);
+    void BuildFlatTemplates(Red::TweakDBRecordInfo* aRecordInfo);
+    const Red::TweakDBHashShift* GetHashShift(const std::array<uint32_t, 32>& aColumns);
 
     Red::TweakDB* m_tweakDb;
     Red::CRTTISystem* m_rtti;
     RecordInfoMap m_resolved;
+    Core::Vector<Core::UniquePtr<Red::TweakDBHashShift>> m_hashShifts;
     std::shared_mutex m_mutex;
+    Core::UniquePtr<const RecordInfoMap> m_frozenStorage;
+    std::atomic<const RecordInfoMap*> m_frozen;
+    ResolveStats m_warmUpStats;
+    std::atomic<uint32_t> m_lazyTypes;
+    std::atomic<uint64_t> m_lazyTime;
 
-    inline static ParentMap s_parentMap;
-    inline static DescendantMap s_descendantMap;
+    inline static Core::SharedPtr<Red::TweakDBInheritance> s_inheritance;
     inline static ExtraFlatMap s_extraFlats;
 };
 }
@@ -31,6 +31,13 @@ end
 
 add_requires("hopscotch-map", "minhook", "spdlog", "tiltedcore", "yaml-cpp")
 
+option("trace")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Record import traces to TweakXL.trace.json")
+    add_defines("TRACE")
+option_end()
+
 target("TweakXL")
     set_default(true)
     set_kind("shared")
@@ -43,6 +50,28 @@ target("TweakXL")
     add_packages("hopscotch-map", "minhook", "spdlog", "tiltedcore", "yaml-cpp")
     add_syslinks("Version", "User32")
     add_defines("WINVER=0x0601", "WIN32_LEAN_AND_MEAN", "NOMINMAX")
+    add_options("trace")
+    set_configdir("src")
+    add_configfiles("config/Project.hpp.in", {prefixdir = "App"})
+    add_configfiles("config/Version.rc.in", {prefixdir = "App"})
+    set_configvar("AUTHOR", "psiberx")
+    set_configvar("NAME", "TweakXL")
+
+-- Runs synthetic workloads on a stand-in database and reports to TweakXLBench.bench.json,
+-- the plugin sources are built again with the benchmarks, so nothing of them ends up in TweakXL.dll
+target("TweakXLBench")
+    set_default(false)
+    set_kind("shared")
+    set_filename("TweakXLBench.dll")
+    set_pcxxheader("src/pch.hpp")
+    add_files("src/**.cpp", "src/**.rc", "lib/**.cpp", "bench/**.cpp")
+    add_headerfiles("src/**.hpp", "lib/**.hpp", "bench/**.hpp")
+    add_includedirs("src/", "lib/", "bench/")
+    add_deps("RED4ext.SDK", "nameof", "semver", "wil", "pegtl")
+    add_packages("hopscotch-map", "minhook", "spdlog", "tiltedcore", "yaml-cpp")
+    add_syslinks("Version", "User32", "Psapi")
+    add_defines("WINVER=0x0601", "WIN32_LEAN_AND_MEAN", "NOMINMAX", "BENCH")
+    add_options("trace")
     set_configdir("src")
     add_configfiles("config/Project.hpp.in", {prefixdir = "App"})
     add_configfiles("config/Version.rc.in", {prefixdir = "App"})